@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,12 +7,32 @@
 #include <math.h>
 #include <time.h>
 #include <unistd.h>
+#include <stdint.h>
+#include <errno.h>
+#include <stddef.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 #define MAX_CODE_SIZE 10000
 #define MAX_VARIABLES 1000
 #define MAX_STRING_LEN 1000
 #define MAX_FILENAME_LEN 256
 #define MAX_STACK_SIZE 100
+#define MEMO_BUCKETS 1024
+#define MEMO_MIN_SEGMENT 8
 
 // Console colors
 #define RESET "\033[0m"
@@ -24,17 +45,118 @@
 #define WHITE "\033[37m"
 #define BOLD "\033[1m"
 
+// Arbitrary-precision integer (type 8, --bignum): base 10^9 limbs, least
+// significant first, so decimal output is a straight limb-by-limb copy.
+// Variables own their bignum through the interpreter's list, freed with
+// the run; intermediate results are plain allocations.
+typedef struct BigNum {
+    struct BigNum *next;
+    int sign;     // -1, 0 or 1
+    int len;      // limbs in use, no leading zero limbs
+    uint32_t limbs[];
+} BigNum;
+
+#define BIG_BASE 1000000000u
+#define BIG_DIGITS 9
+#define KARATSUBA_CUTOFF 32
+#define BIGNUM_MAX_LIMBS (1 << 17)
+
+// Numeric array (type 7): elements live outside the variable slot in a
+// 32-byte aligned block, owned by the interpreter's list like bignums
+typedef struct NumArray {
+    struct NumArray *next;
+    size_t length;
+    double *data;
+} NumArray;
+
+#define ARRAY_MAX_LENGTH (1 << 24)
+#define ARRAY_PARALLEL_MIN (1 << 16)
+#define ARRAY_MAX_THREADS 8
+
+// String (type 4): up to STR_INLINE - 1 bytes live in the variable slot;
+// longer text is a rope whose leaves are interned in the run's string
+// arena, so appending to a long string copies O(log n) nodes, not text
+typedef struct Rope {
+    size_t length;
+    int height;                  // 0 for leaves
+    struct Rope *left;           // inner nodes
+    struct Rope *right;
+    struct Rope *next_interned;  // leaves: intern table chain
+    uint64_t hash;               // leaves: FNV-1a of the text
+    char text[];                 // leaves: NUL-terminated
+} Rope;
+
+#define STR_INLINE 24
+#define ROPE_LEAF_MAX 512
+#define INTERN_BUCKETS 1024
+#define ARENA_CHUNK_SIZE 65536
+#define STRING_MAX_LENGTH (1 << 26)
+
+typedef struct {
+    Rope *rope;              // NULL when the text is inline
+    char chars[STR_INLINE];
+} NumStr;
+
+typedef struct ArenaChunk {
+    struct ArenaChunk *next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} ArenaChunk;
+
+// Dictionary (type 9, --dicts): SwissTable-style open addressing. Each
+// slot has a control byte (empty, deleted, or 7 bits of its key hash);
+// lookups compare 16 control bytes at once and only read slots whose byte
+// matches. Keys are ints or interned string leaves (so string keys compare
+// by pointer); values are scalars or pointers into the run's storage.
+typedef union {
+    long long int_key;
+    Rope *str_key;
+} DictKey;
+
+typedef struct {
+    uint64_t hash;
+    DictKey key;
+    int key_type;     // 3 or 4
+    int value_type;   // 3 to 8
+    union {
+        long long int_val;
+        Rope *str_val;
+        bool bool_val;
+        double float_val;
+        NumArray *array_val;
+        BigNum *big_val;
+    } value;
+} DictSlot;
+
+typedef struct NumDict {
+    struct NumDict *next;
+    size_t count;
+    size_t tombstones;
+    size_t capacity;    // slots, a power of two, at least DICT_GROUP
+    uint8_t *control;
+    DictSlot *slots;
+} NumDict;
+
+#define DICT_GROUP 16
+#define DICT_MAX_ENTRIES (1 << 24)
+#define CTRL_EMPTY 0x80
+#define CTRL_DELETED 0xFE
+
 typedef struct {
-    int type; // 3=int, 4=string, 5=bool, 6=float, 7=array
+    int type; // 3=int, 4=string, 5=bool, 6=float, 7=array, 8=bignum, 9=dict
     char name[50];
+    int origin;    // position named in name, -1 for none
+    int origin_at; // where that position starts in name
     union {
-        int int_val;
-        char str_val[MAX_STRING_LEN];
+        long long int_val;
+        NumStr str_val;
         bool bool_val;
         double float_val;
-        int array_val[100];
+        NumArray *array_val;
+        BigNum *big_val;
+        NumDict *dict_val;
     } value;
-    int array_size;
 } Variable;
 
 typedef struct {
@@ -42,757 +164,6152 @@ typedef struct {
     int condition_result;
 } StackFrame;
 
+// Active loop: counters live here, not in the variable table
+typedef struct {
+    int start;          // loop header position
+    int end;            // END-LOOP position
+    long total;         // iteration count, -1 for condition loops
+    long remaining;
+    long iteration;
+    const char *name;
+} LoopFrame;
+
+// Decoded digits: context (neighbour digits, position) is resolved once at
+// load time so execution never looks at the surrounding code again
+typedef enum {
+    OP_BIT,          // 0/1: binary payload digit
+    OP_TWO,          // 2: end of binary payload, else loop (arg = previous digit, 2 = END-LOOP)
+    OP_INT_VAR,      // 3: integer variable (arg = next digit)
+    OP_FLOAT_VAR,    // 3 next to a 6: float variable
+    OP_STRING_VAR,   // 4: string variable
+    OP_DISPLAY,      // 4 next to a 7: display last variable
+    OP_BOOL_VAR,     // 5: boolean variable
+    OP_CONTROL,      // 5 next to a 6: execution control
+    OP_CONDITIONAL,  // 6 (arg = previous digit: 1 IF, 2 ELSE, 6 END-IF)
+    OP_IO,           // 7 (arg = position % 10)
+    OP_MATH,         // 8 (arg = previous digit)
+    OP_FILE,         // 9
+    OP_ARRAY_VAR,    // 3 before a 7 with --arrays: numeric array
+    OP_DICT,         // 9 after 3, 0, 1 or 2 with --dicts (arg = previous digit)
+    OP_UNKNOWN
+} OpCode;
+
+typedef struct {
+    unsigned char op;
+    unsigned char arg;
+} Instruction;
+
+// Recorded effects of one pure segment, replayed on a cache hit: output,
+// appended variables and the whole resulting stack (END-IF pops frames)
+typedef struct MemoEntry {
+    uint64_t key;
+    int start;
+    int end_position;
+    char *output;
+    size_t output_len;
+    Variable *new_vars;
+    int new_var_count;
+    StackFrame *frames;
+    int frame_count;
+    int loop_depth;
+    int binary_start;
+    char color[20];
+    bool relocatable;   // keyed by relative positions, replayable at any start
+    uint32_t tag;       // position marker tag of the recording
+    struct MemoEntry *next;
+} MemoEntry;
+
+// Per-run resource limits for hosting untrusted programs, 0 = unlimited
+typedef struct {
+    long max_instructions;
+    double max_seconds;
+    int max_variables;
+    long max_output_bytes;
+    int max_report_files;
+} ResourceLimits;
+
+// What one run of a compiled program can use, from a pass over its digits
+// (plan_resources). Counts are upper bounds; PLAN_UNBOUNDED where a loop or
+// an extension can repeat or grow them.
+#define PLAN_UNBOUNDED -1
+#define OUTPUT_OP_BUDGET 2048  // most one digit prints without strings or input
+#define OUTPUT_RUN_BUDGET 4096 // summaries printed once per run
+
+typedef struct {
+    int digits[10];
+    int loop_digits;     // digits inside paired loop bodies
+    int variables;
+    int if_frames;
+    int loop_frames;
+    int report_files;    // distinct numo_output_<position>.txt files
+    long output_bytes;
+} ResourcePlan;
+
+// Limit that stopped a run; each one has its own exit code
+typedef enum {
+    LIMIT_NONE,
+    LIMIT_INSTRUCTIONS,
+    LIMIT_TIME,
+    LIMIT_VARIABLES,
+    LIMIT_OUTPUT,
+    LIMIT_REPORTS
+} LimitKind;
+
+#define LIMIT_CLOCK_INTERVAL 1024
+
+// Why numo_run_for() returned
+typedef enum {
+    RUN_FINISHED,
+    RUN_YIELDED,        // step budget used up, call again to continue
+    RUN_WAITING_INPUT,  // next op needs host input (numo_provide_input)
+    RUN_ERROR           // stopped by a resource limit (see limit_hit)
+} RunStatus;
+
+// What clear (73), pause (74) and bell (78) do to the terminal
+typedef enum {
+    TERM_LIVE,          // clear sequence written, bell rung, pause waits on a tty
+    TERM_HEADLESS,      // all three are no-ops (--headless)
+    TERM_RECORD         // no-ops, each noted in the output (--headless-record)
+} TermMode;
+
 typedef struct {
-    Variable vars[MAX_VARIABLES];
+    Variable *vars;          // var_capacity slots, sized by the resource plan
     int var_count;
+    int var_capacity;
+    ResourcePlan plan;
     char code[MAX_CODE_SIZE];
+    Instruction *program;    // own_program, or a --shm-cache mapping
+    int *jump_table;         // own_jump_table, or the same mapping
     int position;
     int code_length;
     bool debug_mode;
     StackFrame stack[MAX_STACK_SIZE];
     int stack_pointer;
+    LoopFrame loops[MAX_STACK_SIZE];
+    int loop_sp;
     int loop_depth;
     char current_color[20];
+    int binary_start;
+    FILE *out;
+    bool memo_enabled;
+    int *segment_end;        // own_segment_end, or the same mapping
+    MemoEntry *memo_buckets[MEMO_BUCKETS];
+    int memo_hits;
+    int memo_misses;
+    bool folded;
+    int fold_position;
+    char *fold_output;
+    size_t fold_output_len;
+    bool jit_enabled;
+    unsigned char *jit_code;
+    size_t jit_size;
+    int jit_offsets[MAX_CODE_SIZE];
+    ResourceLimits limits;
+    bool limits_active;
+    LimitKind limit_hit;
+    long instructions_executed;
+    int clock_countdown;
+    struct timespec run_start;
+    long output_bytes;
+    int report_files;
+    FILE *sink;
+    bool host_input;
+    char *input_data;
+    size_t input_len;
+    size_t input_pos;
+    bool input_closed;
+    bool input_tty;       // stdin is a terminal: reads go through stdio, pause waits
+    TermMode term_mode;
+    bool run_started;
+    bool run_finished;
+    bool bignum_enabled;
+    BigNum *bignums;
+    bool arrays_enabled;
+    NumArray *arrays;
+    bool strings_enabled;
+    ArenaChunk *string_arena;
+    Rope *interned[INTERN_BUCKETS];
+    bool dicts_enabled;
+    NumDict *dicts;
+    const char *cache_dir;   // --cache-dir: compile cache, NULL when off
+    int reloc_base;          // start of the relocatable segment recording, or -1
+    uint32_t reloc_tag;
+    char pos_text_buf[4][24];
+    int pos_text_next;
+    bool shm_cache;
+    void *shared_code;       // read-only /dev/shm entry, NULL when not mapped
+    size_t shared_size;
+    int shared_fd;           // holds the entry's shared lock
+    Instruction own_program[MAX_CODE_SIZE];
+    int own_jump_table[MAX_CODE_SIZE];
+    int own_segment_end[MAX_CODE_SIZE];
 } NumoInterpreter;
 
-// Initialize interpreter
-void init_interpreter(NumoInterpreter *interp) {
-    interp->var_count = 0;
-    interp->position = 0;
-    interp->code_length = 0;
-    interp->debug_mode = false;
-    interp->stack_pointer = 0;
-    interp->loop_depth = 0;
-    strcpy(interp->current_color, RESET);
-    memset(interp->code, 0, MAX_CODE_SIZE);
-    srand(time(NULL));
+// Free the bignums owned by variables of the current run
+void free_bignums(NumoInterpreter *interp) {
+    while (interp->bignums) {
+        BigNum *next = interp->bignums->next;
+        free(interp->bignums);
+        interp->bignums = next;
+    }
 }
 
-// Load .num file
-bool load_numo_file(NumoInterpreter *interp, const char *filename) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        printf(RED "Error: Cannot open file %s\n" RESET, filename);
-        return false;
+// Free the arrays owned by variables of the current run
+void free_arrays(NumoInterpreter *interp) {
+    while (interp->arrays) {
+        NumArray *next = interp->arrays->next;
+        free(interp->arrays->data);
+        free(interp->arrays);
+        interp->arrays = next;
     }
+}
 
-    char ch;
-    int i = 0;
-    while ((ch = fgetc(file)) != EOF && i < MAX_CODE_SIZE - 1) {
-        if (isdigit(ch)) {
-            interp->code[i++] = ch;
-        }
+// FNV-1a hashing for memo keys and interned strings
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+uint64_t hash_bytes(uint64_t hash, const void *data, size_t len) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
     }
-    interp->code[i] = '\0';
-    interp->code_length = i;
-    fclose(file);
+    return hash;
+}
 
-    printf(GREEN "Loaded Numo 0-9 program: %d digits\n" RESET, interp->code_length);
-    return true;
+// Free the string arena (rope nodes and interned leaves) of the current run
+void free_string_arena(NumoInterpreter *interp) {
+    while (interp->string_arena) {
+        ArenaChunk *next = interp->string_arena->next;
+        free(interp->string_arena);
+        interp->string_arena = next;
+    }
+    memset(interp->interned, 0, sizeof(interp->interned));
 }
 
-// Set console color
-void set_color(NumoInterpreter *interp, int color_code) {
-    switch (color_code) {
-        case 0: strcpy(interp->current_color, RESET); break;
-        case 1: strcpy(interp->current_color, RED); break;
-        case 2: strcpy(interp->current_color, GREEN); break;
-        case 3: strcpy(interp->current_color, YELLOW); break;
-        case 4: strcpy(interp->current_color, BLUE); break;
-        case 5: strcpy(interp->current_color, MAGENTA); break;
-        case 6: strcpy(interp->current_color, CYAN); break;
-        case 7: strcpy(interp->current_color, WHITE); break;
-        case 8: strcpy(interp->current_color, BOLD); break;
-        case 9: strcpy(interp->current_color, RESET); break;
+// Bump allocation from the string arena; blocks over a quarter chunk get a
+// chunk of their own behind the current one
+void *arena_alloc(NumoInterpreter *interp, size_t size) {
+    size = (size + 7) & ~(size_t)7;
+    ArenaChunk *chunk = interp->string_arena;
+    if (chunk && chunk->capacity - chunk->used >= size) {
+        void *block = chunk->data + chunk->used;
+        chunk->used += size;
+        return block;
+    }
+
+    bool dedicated = size > ARENA_CHUNK_SIZE / 4;
+    size_t capacity = dedicated ? size : ARENA_CHUNK_SIZE;
+    ArenaChunk *fresh = malloc(sizeof(ArenaChunk) + capacity);
+    if (!fresh) return NULL;
+    fresh->capacity = capacity;
+    fresh->used = size;
+    if (dedicated && chunk) {
+        fresh->next = chunk->next;
+        chunk->next = fresh;
+    } else {
+        fresh->next = chunk;
+        interp->string_arena = fresh;
     }
+    return fresh->data;
 }
 
-// Execute binary code (0s and 1s)
-void execute_binary(NumoInterpreter *interp, int start, int end) {
-    printf(CYAN "Executing binary sequence from position %d to %d\n" RESET, start, end);
-
-    printf("%s", interp->current_color);
-    for (int i = start; i < end; i += 8) {
-        if (i + 7 < end) {
-            int ascii_val = 0;
-            for (int j = 0; j < 8; j++) {
-                if (interp->code[i + j] == '1') {
-                    ascii_val |= (1 << (7 - j));
-                }
-            }
-            if (ascii_val >= 32 && ascii_val <= 126) {
-                printf("%c", ascii_val);
-            } else if (ascii_val == 0) {
-                printf(" "); // Space for null characters
-            }
+// Leaf holding text, shared with any earlier leaf of the same text
+Rope *intern_leaf(NumoInterpreter *interp, const char *text, size_t length) {
+    uint64_t hash = hash_bytes(FNV_OFFSET, text, length);
+    Rope **bucket = &interp->interned[hash % INTERN_BUCKETS];
+    for (Rope *leaf = *bucket; leaf; leaf = leaf->next_interned) {
+        if (leaf->hash == hash && leaf->length == length && memcmp(leaf->text, text, length) == 0) {
+            return leaf;
         }
     }
-    printf(RESET "\n");
-    fflush(stdout); // Force output
+
+    Rope *leaf = arena_alloc(interp, sizeof(Rope) + length + 1);
+    if (!leaf) return NULL;
+    leaf->length = length;
+    leaf->height = 0;
+    leaf->left = leaf->right = NULL;
+    leaf->hash = hash;
+    memcpy(leaf->text, text, length);
+    leaf->text[length] = '\0';
+    leaf->next_interned = *bucket;
+    *bucket = leaf;
+    return leaf;
 }
 
-// Create variable (type 3, 4, 5, 6, 7)
-void create_variable(NumoInterpreter *interp, int type, int position) {
-    if (interp->var_count >= MAX_VARIABLES) return;
+// Immutable inner node; NULL if either side failed to allocate
+Rope *rope_node(NumoInterpreter *interp, Rope *left, Rope *right) {
+    if (!left || !right) return NULL;
+    Rope *node = arena_alloc(interp, sizeof(Rope));
+    if (!node) return NULL;
+    node->length = left->length + right->length;
+    node->height = 1 + (left->height > right->height ? left->height : right->height);
+    node->left = left;
+    node->right = right;
+    node->next_interned = NULL;
+    node->hash = 0;
+    return node;
+}
 
-    Variable *var = &interp->vars[interp->var_count];
-    var->type = type;
-    sprintf(var->name, "var_%d_%d", type, position);
+// Node over two ropes whose heights differ by at most 2, rotated so they
+// differ by at most 1 (AVL)
+Rope *rope_balance(NumoInterpreter *interp, Rope *left, Rope *right) {
+    if (!left || !right) return NULL;
+    if (left->height > right->height + 1) {
+        if (left->left->height >= left->right->height) {
+            return rope_node(interp, left->left, rope_node(interp, left->right, right));
+        }
+        Rope *middle = left->right;
+        return rope_node(interp, rope_node(interp, left->left, middle->left),
+                         rope_node(interp, middle->right, right));
+    }
+    if (right->height > left->height + 1) {
+        if (right->right->height >= right->left->height) {
+            return rope_node(interp, rope_node(interp, left, right->left), right->right);
+        }
+        Rope *middle = right->left;
+        return rope_node(interp, rope_node(interp, left, middle->left),
+                         rope_node(interp, middle->right, right->right));
+    }
+    return rope_node(interp, left, right);
+}
 
-    switch (type) {
-        case 3: // Numeric variable (integers)
-            // Look at the next digit to get the value
-            if (interp->position + 1 < interp->code_length) {
-                var->value.int_val = interp->code[interp->position + 1] - '0';
-            } else {
-                var->value.int_val = position % 10;
-            }
-            printf(YELLOW "Created numeric variable %s = %d\n" RESET, var->name, var->value.int_val);
-            break;
-        case 4: // Text string variable
-            sprintf(var->value.str_val, "text_%d", position);
-            printf(MAGENTA "Created text variable %s = \"%s\"\n" RESET, var->name, var->value.str_val);
-            break;
-        case 5: // Boolean variable
-            var->value.bool_val = (position % 2 == 0);
-            printf(BLUE "Created boolean variable %s = %s\n" RESET, var->name, 
-                   var->value.bool_val ? "true" : "false");
-            break;
-        case 6: // Float variable
-            var->value.float_val = (double)(position % 100) / 10.0;
-            printf(GREEN "Created float variable %s = %.2f\n" RESET, var->name, var->value.float_val);
-            break;
-        case 7: // Array variable
-            var->array_size = 5;
-            for (int i = 0; i < var->array_size; i++) {
-                var->value.array_val[i] = (position + i) % 10;
-            }
-            printf(CYAN "Created array variable %s with %d elements\n" RESET, var->name, var->array_size);
-            break;
+// Balanced concatenation: descends the taller rope's inner spine to the
+// other's height, so it allocates O(log n) nodes and copies no text
+Rope *rope_join(NumoInterpreter *interp, Rope *left, Rope *right) {
+    if (left->height > right->height + 1) {
+        return rope_balance(interp, left->left, rope_join(interp, left->right, right));
     }
-    interp->var_count++;
+    if (right->height > left->height + 1) {
+        return rope_balance(interp, rope_join(interp, left, right->left), right->right);
+    }
+    return rope_node(interp, left, right);
 }
 
-// Advanced mathematical operations - FIXED
-void handle_advanced_math(NumoInterpreter *interp, int operation, int position) {
-    if (interp->var_count < 2) {
-        printf(RED "Error: Need at least 2 variables for math operation\n" RESET);
+size_t string_length(const NumStr *str) {
+    return str->rope ? str->rope->length : strlen(str->chars);
+}
+
+// Copy a rope's text into dst (length bytes, not terminated)
+void rope_flatten(const Rope *rope, char *dst) {
+    if (rope->height == 0) {
+        memcpy(dst, rope->text, rope->length);
         return;
     }
+    rope_flatten(rope->left, dst);
+    rope_flatten(rope->right, dst + rope->left->length);
+}
 
-    double val1 = 0, val2 = 0;
-    int found_vars = 0;
+void string_flatten(const NumStr *str, char *dst) {
+    if (str->rope) {
+        rope_flatten(str->rope, dst);
+    } else {
+        memcpy(dst, str->chars, strlen(str->chars));
+    }
+}
 
-    // Get the last two numeric variables
-    for (int i = interp->var_count - 1; i >= 0 && found_vars < 2; i--) {
-        if (interp->vars[i].type == 3 || interp->vars[i].type == 6) {
-            double value = (interp->vars[i].type == 3) ? 
-                          (double)interp->vars[i].value.int_val : 
-                          interp->vars[i].value.float_val;
+// Store text inline when it fits, else as an interned leaf
+bool string_set(NumoInterpreter *interp, NumStr *str, const char *text, size_t length) {
+    if (length < STR_INLINE) {
+        memcpy(str->chars, text, length);
+        str->chars[length] = '\0';
+        str->rope = NULL;
+        return true;
+    }
+    str->chars[0] = '\0';
+    str->rope = intern_leaf(interp, text, length);
+    return str->rope != NULL;
+}
 
-            if (found_vars == 0) {
-                val1 = value; // Most recent variable
-            } else if (found_vars == 1) {
-                val2 = value; // Second most recent variable
-            }
-            found_vars++;
-        }
+// a followed by b; short results are flat, long ones a rope join
+bool string_concat(NumoInterpreter *interp, NumStr *out, const NumStr *a, const NumStr *b) {
+    size_t a_len = string_length(a);
+    size_t b_len = string_length(b);
+    if (a_len + b_len <= ROPE_LEAF_MAX) {
+        char buffer[ROPE_LEAF_MAX];
+        string_flatten(a, buffer);
+        string_flatten(b, buffer + a_len);
+        return string_set(interp, out, buffer, a_len + b_len);
     }
 
-    if (found_vars < 2) {
-        printf(RED "Error: Not enough numeric variables for operation\n" RESET);
+    Rope *left = a->rope ? a->rope : intern_leaf(interp, a->chars, a_len);
+    Rope *right = b->rope ? b->rope : intern_leaf(interp, b->chars, b_len);
+    out->chars[0] = '\0';
+    out->rope = (left && right) ? rope_join(interp, left, right) : NULL;
+    return out->rope != NULL;
+}
+
+// Write a rope, stopping once *budget bytes are out
+void rope_write(FILE *out, const Rope *rope, size_t *budget) {
+    if (*budget == 0) return;
+    if (rope->height == 0) {
+        size_t count = rope->length < *budget ? rope->length : *budget;
+        fwrite(rope->text, 1, count, out);
+        *budget -= count;
         return;
     }
+    rope_write(out, rope->left, budget);
+    rope_write(out, rope->right, budget);
+}
 
-    double result = 0;
-    char op_name[20];
-    char op_symbol = '?';
+// Whole string, or its first `limit` bytes then "..." (limit 0 = all)
+void print_string(FILE *out, const NumStr *str, size_t limit) {
+    size_t length = string_length(str);
+    size_t budget = (limit && length > limit) ? limit : length;
+    if (str->rope) {
+        rope_write(out, str->rope, &budget);
+    } else {
+        fwrite(str->chars, 1, budget, out);
+    }
+    if (limit && length > limit) fprintf(out, "...");
+}
 
-    switch (operation) {
-        case 0: // Addition
-            result = val2 + val1;
-            strcpy(op_name, "Addition");
-            op_symbol = '+';
-            break;
-        case 1: // Subtraction
-            result = val2 - val1;
-            strcpy(op_name, "Subtraction");
-            op_symbol = '-';
-            break;
-        case 2: // Multiplication
-            result = val2 * val1;
-            strcpy(op_name, "Multiplication");
-            op_symbol = '*';
-            break;
-        case 3: // Division
-            if (val1 != 0) {
-                result = val2 / val1;
-            } else {
-                result = 0;
-                printf(RED "Warning: Division by zero!\n" RESET);
-            }
-            strcpy(op_name, "Division");
-            op_symbol = '/';
-            break;
-        case 4: // Power
-            result = pow(val2, val1);
-            strcpy(op_name, "Power");
-            op_symbol = '^';
-            break;
-        case 5: // Square root
-            result = sqrt(val1);
-            strcpy(op_name, "Square root");
-            break;
-        case 6: // Sine
-            result = sin(val1);
-            strcpy(op_name, "Sine");
-            break;
-        case 7: // Cosine
-            result = cos(val1);
-            strcpy(op_name, "Cosine");
-            break;
-        case 8: // Logarithm
-            if (val1 > 0) {
-                result = log(val1);
+uint64_t rope_hash(uint64_t hash, const Rope *rope) {
+    if (rope->height == 0) return hash_bytes(hash, rope->text, rope->length);
+    return rope_hash(rope_hash(hash, rope->left), rope->right);
+}
+
+// Free the dictionaries owned by variables of the current run
+void free_dicts(NumoInterpreter *interp) {
+    while (interp->dicts) {
+        NumDict *next = interp->dicts->next;
+        free(interp->dicts->control);
+        free(interp->dicts->slots);
+        free(interp->dicts);
+        interp->dicts = next;
+    }
+}
+
+// Reset execution state so a loaded program can run again
+void reset_run_state(NumoInterpreter *interp) {
+    free_bignums(interp);
+    free_arrays(interp);
+    free_string_arena(interp);
+    free_dicts(interp);
+    interp->var_count = 0;
+    interp->position = 0;
+    interp->stack_pointer = 0;
+    interp->loop_sp = 0;
+    interp->loop_depth = 0;
+    strcpy(interp->current_color, RESET);
+    interp->binary_start = -1;
+    interp->limit_hit = LIMIT_NONE;
+    interp->instructions_executed = 0;
+    interp->clock_countdown = LIMIT_CLOCK_INTERVAL;
+    interp->output_bytes = 0;
+    interp->report_files = 0;
+    interp->run_started = false;
+    interp->run_finished = false;
+}
+
+// Initialize interpreter
+void init_interpreter(NumoInterpreter *interp) {
+    interp->bignums = NULL;
+    interp->bignum_enabled = false;
+    interp->arrays = NULL;
+    interp->arrays_enabled = false;
+    interp->string_arena = NULL;
+    interp->strings_enabled = false;
+    interp->dicts = NULL;
+    interp->dicts_enabled = false;
+    interp->cache_dir = NULL;
+    interp->shm_cache = false;
+    interp->shared_code = NULL;
+    interp->reloc_base = -1;
+    interp->reloc_tag = (uint32_t)time(NULL) ^ ((uint32_t)getpid() << 12) ^ (uint32_t)(uintptr_t)interp;
+    interp->pos_text_next = 0;
+    interp->vars = NULL;
+    interp->var_capacity = 0;
+    interp->program = interp->own_program;
+    interp->jump_table = interp->own_jump_table;
+    interp->segment_end = interp->own_segment_end;
+    reset_run_state(interp);
+    interp->code_length = 0;
+    interp->debug_mode = false;
+    interp->out = stdout;
+    interp->memo_enabled = false;
+    memset(interp->memo_buckets, 0, sizeof(interp->memo_buckets));
+    interp->memo_hits = 0;
+    interp->memo_misses = 0;
+    interp->folded = false;
+    interp->fold_position = 0;
+    interp->fold_output = NULL;
+    interp->fold_output_len = 0;
+    interp->jit_enabled = false;
+    interp->jit_code = NULL;
+    interp->jit_size = 0;
+    memset(&interp->limits, 0, sizeof(interp->limits));
+    interp->limits_active = false;
+    interp->sink = NULL;
+    interp->host_input = false;
+    interp->input_data = NULL;
+    interp->input_len = 0;
+    interp->input_pos = 0;
+    interp->input_closed = false;
+    interp->input_tty = isatty(STDIN_FILENO);
+    interp->term_mode = TERM_LIVE;
+    memset(interp->code, 0, MAX_CODE_SIZE);
+    srand(time(NULL));
+}
+
+// Positions shown by handlers, in output and in variable names, go through
+// pos_text. While a relocatable memo entry records (run_memoized_segment),
+// it writes a marker instead: POS_MARK, the recording's tag as 8 hex digits,
+// the offset from the segment start, POS_MARK_END. Replay turns markers
+// back into numbers for the start it runs at.
+#define POS_MARK '\x01'
+#define POS_MARK_END '\x02'
+
+const char *pos_text(NumoInterpreter *interp, int position) {
+    char *text = interp->pos_text_buf[interp->pos_text_next];
+    interp->pos_text_next = (interp->pos_text_next + 1) % 4;
+    if (interp->reloc_base >= 0) {
+        snprintf(text, sizeof(interp->pos_text_buf[0]), "%c%08x%d%c", POS_MARK, interp->reloc_tag,
+                 position - interp->reloc_base, POS_MARK_END);
+    } else {
+        snprintf(text, sizeof(interp->pos_text_buf[0]), "%d", position);
+    }
+    return text;
+}
+
+// Write text with every marker of tag replaced by base + its offset
+void write_positions(FILE *out, const char *text, size_t length, uint32_t tag, int base) {
+    char tag_text[9];
+    snprintf(tag_text, sizeof(tag_text), "%08x", tag);
+    size_t done = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (text[i] != POS_MARK || i + 10 >= length || memcmp(text + i + 1, tag_text, 8) != 0) continue;
+        size_t j = i + 9;
+        if (text[j] == '-') j++;
+        size_t digits = j;
+        while (j < length && isdigit((unsigned char)text[j])) j++;
+        if (j == digits || j == length || text[j] != POS_MARK_END) continue;
+        fwrite(text + done, 1, i - done, out);
+        fprintf(out, "%ld", base + strtol(text + i + 9, NULL, 10));
+        done = j + 1;
+        i = j;
+    }
+    fwrite(text + done, 1, length - done, out);
+}
+
+// Name a variable prefix, position, suffix, remembering where the position
+// sits so a relocated memo replay can rewrite it
+void name_variable(NumoInterpreter *interp, Variable *var, const char *prefix, int position, const char *suffix) {
+    var->origin = position;
+    var->origin_at = strlen(prefix);
+    snprintf(var->name, sizeof(var->name), "%s%s%s", prefix, pos_text(interp, position), suffix);
+}
+
+// Replace the position in a variable's name (a number or a marker) by text
+void rename_position(Variable *var, const char *text) {
+    if (var->origin < 0) return;
+    char *at = var->name + var->origin_at;
+    const char *rest = (*at == POS_MARK) ? strchr(at, POS_MARK_END) + 1 : at + strspn(at, "0123456789");
+    char suffix[sizeof(var->name)];
+    strcpy(suffix, rest);
+    snprintf(at, sizeof(var->name) - var->origin_at, "%s%s", text, suffix);
+}
+
+// Decode one digit with its context
+Instruction decode_instruction(NumoInterpreter *interp, int position) {
+    int prev_digit = (position > 0) ? interp->code[position - 1] - '0' : 0;
+    int next_digit = (position + 1 < interp->code_length) ? interp->code[position + 1] - '0' : 0;
+    Instruction instr = { OP_UNKNOWN, 0 };
+
+    switch (interp->code[position]) {
+        case '0':
+        case '1': instr.op = OP_BIT; break;
+        case '2': instr.op = OP_TWO; instr.arg = prev_digit; break;
+        case '3':
+            if (prev_digit == 6 || next_digit == 6) {
+                instr.op = OP_FLOAT_VAR;
+            } else if (next_digit == 7 && interp->arrays_enabled) {
+                instr.op = OP_ARRAY_VAR;
             } else {
-                result = 0;
-                printf(RED "Warning: Logarithm of non-positive number!\n" RESET);
+                instr.op = OP_INT_VAR;
+                instr.arg = next_digit;
             }
-            strcpy(op_name, "Logarithm");
             break;
-        case 9: // Modulo
-            if (val1 != 0) {
-                result = fmod(val2, val1);
+        case '4': instr.op = (next_digit == 7 || prev_digit == 7) ? OP_DISPLAY : OP_STRING_VAR; break;
+        case '5': instr.op = (prev_digit == 6 || next_digit == 6) ? OP_CONTROL : OP_BOOL_VAR; break;
+        case '6': instr.op = OP_CONDITIONAL; instr.arg = prev_digit; break;
+        case '7': instr.op = OP_IO; instr.arg = position % 10; break;
+        case '8': instr.op = OP_MATH; instr.arg = prev_digit; break;
+        case '9':
+            if (interp->dicts_enabled && position > 0 && prev_digit <= 3) {
+                instr.op = OP_DICT;
+                instr.arg = prev_digit;
             } else {
-                result = 0;
-                printf(RED "Warning: Modulo by zero!\n" RESET);
+                instr.op = OP_FILE;
             }
-            strcpy(op_name, "Modulo");
-            op_symbol = '%';
             break;
     }
+    return instr;
+}
 
-    if (operation <= 4 || operation == 9) {
-        printf(GREEN "%s: %.2f %c %.2f = %.2f\n" RESET, op_name, val2, op_symbol, val1, result);
-    } else {
-        printf(GREEN "%s(%.2f) = %.2f\n" RESET, op_name, val1, result);
-    }
+// Loop headers: 32 WHILE, 42 DO-WHILE, 52 REPEAT, 36 WHILE, 46 FOR. The 1
+// of a 12 always opens a binary payload, so that 2 closes it instead.
+bool is_loop_header(Instruction instr) {
+    if (instr.op == OP_TWO) return instr.arg == 3 || instr.arg == 4 || instr.arg == 5;
+    return instr.op == OP_CONDITIONAL && (instr.arg == 3 || instr.arg == 4);
+}
 
-    // Store result as new variable
-    if (interp->var_count < MAX_VARIABLES) {
-        Variable *var = &interp->vars[interp->var_count];
-        var->type = 6; // Float result
-        sprintf(var->name, "result_%d", position);
-        var->value.float_val = result;
-        printf(CYAN "Result stored in variable %s = %.2f\n" RESET, var->name, result);
-        interp->var_count++;
-    }
+// Paired loop header or END-LOOP (22)
+bool is_loop_marker(NumoInterpreter *interp, int position) {
+    Instruction instr = interp->program[position];
+    return interp->jump_table[position] != -1 &&
+           (is_loop_header(instr) || (instr.op == OP_TWO && instr.arg == 2));
 }
 
-// Handle conditionals (digit 6) - NEW
-void handle_conditionals(NumoInterpreter *interp, int position) {
-    int prev_digit = (position > 0) ? interp->code[position - 1] - '0' : 0;
-    
-    printf(BLUE "Conditional operation (previous digit: %d) at position %d\n" RESET, prev_digit, position);
-    
-    switch (prev_digit) {
-        case 1: // IF condition
-            if (interp->var_count > 0) {
+// Pair IF (16) with its optional ELSE (26) and END-IF (66) so branches
+// jump in O(1). An IF jumps to its ELSE, or to its END-IF without one; an
+// ELSE jumps to its END-IF; an END-IF points back at its IF. Loop headers
+// and END-LOOP (22) point at each other. A 2 closing a binary payload is
+// not a loop marker. Unpaired markers keep -1 and the old behaviour.
+void build_jump_table(NumoInterpreter *interp) {
+    int open_ifs[MAX_CODE_SIZE];
+    int else_of[MAX_CODE_SIZE];
+    int open_loops[MAX_CODE_SIZE];
+    int depth = 0;
+    int loop_depth = 0;
+    bool binary_pending = false;
+
+    for (int i = 0; i < interp->code_length; i++) {
+        Instruction instr = interp->program[i];
+        interp->jump_table[i] = -1;
+
+        if (instr.op == OP_BIT) {
+            binary_pending = true;
+            continue;
+        }
+        if (instr.op == OP_TWO && binary_pending) {
+            binary_pending = false;
+            continue;
+        }
+        if (is_loop_header(instr)) {
+            open_loops[loop_depth++] = i;
+            continue;
+        }
+        if (instr.op == OP_TWO && instr.arg == 2) {
+            if (loop_depth > 0) {
+                int header = open_loops[--loop_depth];
+                interp->jump_table[header] = i;
+                interp->jump_table[i] = header;
+            }
+            continue;
+        }
+        if (instr.op != OP_CONDITIONAL) continue;
+
+        switch (interp->program[i].arg) {
+            case 1:
+                open_ifs[depth] = i;
+                else_of[depth] = -1;
+                depth++;
+                break;
+            case 2:
+                if (depth > 0 && else_of[depth - 1] == -1) {
+                    else_of[depth - 1] = i;
+                }
+                break;
+            case 6:
+                if (depth > 0) {
+                    depth--;
+                    int if_pos = open_ifs[depth];
+                    int else_pos = else_of[depth];
+                    interp->jump_table[if_pos] = (else_pos != -1) ? else_pos : i;
+                    if (else_pos != -1) {
+                        interp->jump_table[else_pos] = i;
+                    }
+                    interp->jump_table[i] = if_pos;
+                }
+                break;
+        }
+    }
+}
+
+// A digit is pure when its effect depends only on the program text and
+// interpreter state: no input, clock, random numbers, screen or files.
+// Loop markers also end segments so a segment never runs backwards.
+bool is_pure_position(NumoInterpreter *interp, int pos) {
+    if (is_loop_marker(interp, pos)) return false;
+    switch (interp->code[pos]) {
+        case '2':
+            // An array sort (62) changes an existing variable, which a memo
+            // entry cannot replay
+            return !(interp->arrays_enabled && pos > 0 && interp->code[pos - 1] == '6');
+        case '7': {
+            int io_type = pos % 10;
+            return io_type == 2 || io_type == 6 || io_type == 7 || io_type == 8;
+        }
+        case '9':
+            return false;
+        default:
+            return true;
+    }
+}
+
+// Record for every position where the pure segment starting there ends
+void analyze_segments(NumoInterpreter *interp) {
+    int end = interp->code_length;
+    for (int pos = interp->code_length - 1; pos >= 0; pos--) {
+        if (!is_pure_position(interp, pos)) {
+            end = pos;
+        }
+        interp->segment_end[pos] = end;
+    }
+}
+
+// Digits that can append a variable, at most one per execution (a split,
+// 92 with --strings, appends one per piece)
+bool may_create_variable(Instruction instr) {
+    switch (instr.op) {
+        case OP_BIT:
+        case OP_DISPLAY:
+        case OP_CONTROL:
+        case OP_FILE:
+        case OP_UNKNOWN:
+            return false;
+        case OP_TWO: // 72 dot product, 82 concatenation, 92 split
+            return instr.arg >= 7;
+        case OP_CONDITIONAL: // 76, 86, 96, 06: reductions and string ops
+            return instr.arg >= 7 || instr.arg == 0;
+        case OP_IO:
+            return instr.arg == 0 || instr.arg == 1 || instr.arg == 5;
+        default:
+            return true;
+    }
+}
+
+// One pass over the compiled program. The only backward jump is END-LOOP
+// to its paired header, so a digit outside every paired loop body runs at
+// most once per run; counting those bounds variables and IF frames. A
+// loop frame is live at most once per paired header.
+void plan_resources(NumoInterpreter *interp, ResourcePlan *plan) {
+    int length = interp->code_length;
+    int *body = calloc(length + 1, sizeof(int)); // +1 at body start, -1 after its end
+    memset(plan, 0, sizeof(*plan));
+    for (int i = 0; i < length; i++) {
+        int end = interp->jump_table[i];
+        if (is_loop_header(interp->program[i]) && end > i) {
+            plan->loop_frames++;
+            if (body) {
+                body[i + 1]++;
+                body[end + 1]--;
+            }
+        }
+    }
+
+    bool reads_text = false;
+    int depth = 0;
+    for (int i = 0; i < length; i++) {
+        Instruction instr = interp->program[i];
+        depth += body ? body[i] : 1;
+        bool repeats = depth > 0;
+        plan->digits[interp->code[i] - '0']++;
+        if (repeats) plan->loop_digits++;
+
+        if (may_create_variable(instr) && plan->variables != PLAN_UNBOUNDED) {
+            bool split = instr.op == OP_TWO && instr.arg == 9 && interp->strings_enabled;
+            plan->variables = (repeats || split) ? PLAN_UNBOUNDED : plan->variables + 1;
+        }
+        if (instr.op == OP_CONDITIONAL && instr.arg == 1 && plan->if_frames != PLAN_UNBOUNDED) {
+            plan->if_frames = repeats ? PLAN_UNBOUNDED : plan->if_frames + 1;
+        }
+        if (instr.op == OP_FILE) plan->report_files++;
+        if (instr.op == OP_IO && instr.arg == 1) reads_text = true;
+    }
+    free(body);
+
+    bool grows = interp->strings_enabled || interp->bignum_enabled || interp->arrays_enabled ||
+                 interp->dicts_enabled || reads_text;
+    plan->output_bytes = (plan->loop_digits > 0 || grows)
+                             ? PLAN_UNBOUNDED
+                             : (long)length * OUTPUT_OP_BUDGET + OUTPUT_RUN_BUDGET;
+}
+
+// Allocate the variable store for the plan: exactly the bound, or the
+// MAX_VARIABLES ceiling when the program has none
+void size_variable_store(NumoInterpreter *interp) {
+    int bound = interp->plan.variables;
+    int capacity = (bound == PLAN_UNBOUNDED || bound > MAX_VARIABLES) ? MAX_VARIABLES : bound;
+    Variable *vars = realloc(interp->vars, (capacity > 0 ? capacity : 1) * sizeof(Variable));
+    if (!vars) {
+        fprintf(interp->out, RED "Error: Cannot allocate %d variables\n" RESET, capacity);
+        free(interp->vars);
+        capacity = 0;
+    }
+    interp->vars = vars;
+    interp->var_capacity = capacity;
+}
+
+// On-disk compile cache (--cache-dir). An entry holds the decoded
+// instruction stream, jump table and segment ends of one program, keyed by
+// the digits, the flags that change decoding and CACHE_FORMAT. Bump
+// CACHE_FORMAT whenever decoding, Instruction, the jump table or the
+// segment ends (which memo keys rely on) change, so old entries miss.
+// Layout: "NUMOCACHE" header with key, digit count and a hash of the
+// arrays, then jump_table[], segment_end[] and program[] exactly as
+// held in memory (ints first, so they stay aligned in a mapping), then the
+// digits (compared on a hit, so a key collision is only a miss). A damaged
+// entry fails the hash and is rebuilt.
+#define CACHE_MAGIC "NUMOCACHE"
+#define CACHE_FORMAT 3
+
+// Shared compile cache (--shm-cache): the same entries in /dev/shm, mapped
+// read-only instead of copied, so every process running a program uses one
+// copy. Each mapping holds a shared lock on its entry (an open file
+// description lock, dropped by the kernel when the holder exits); eviction
+// removes the least recently used entries that no one holds.
+#define SHM_CACHE_DIR "/dev/shm"
+#define SHM_CACHE_ENTRIES 16
+
+typedef struct {
+    char magic[10];
+    uint8_t format;
+    uint8_t flags;
+    uint64_t key;
+    uint32_t code_length;
+    uint32_t instruction_size;
+    uint64_t payload_hash;
+} CacheHeader;
+
+uint8_t cache_flags(NumoInterpreter *interp) {
+    return (interp->arrays_enabled ? 1 : 0) | (interp->dicts_enabled ? 2 : 0);
+}
+
+uint64_t cache_key(NumoInterpreter *interp) {
+    uint64_t hash = hash_bytes(FNV_OFFSET, interp->code, interp->code_length);
+    uint8_t flags = cache_flags(interp);
+    uint8_t format = CACHE_FORMAT;
+    hash = hash_bytes(hash, (const char *)&flags, 1);
+    return hash_bytes(hash, (const char *)&format, 1);
+}
+
+void cache_header(NumoInterpreter *interp, CacheHeader *header) {
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, CACHE_MAGIC, sizeof(header->magic));
+    header->format = CACHE_FORMAT;
+    header->flags = cache_flags(interp);
+    header->key = cache_key(interp);
+    header->code_length = interp->code_length;
+    header->instruction_size = sizeof(Instruction);
+}
+
+uint64_t cache_payload_hash(const void *jumps, const void *ends, const void *program, int length) {
+    uint64_t hash = hash_bytes(FNV_OFFSET, jumps, length * sizeof(int));
+    hash = hash_bytes(hash, ends, length * sizeof(int));
+    return hash_bytes(hash, program, length * sizeof(Instruction));
+}
+
+size_t cache_size(int length) {
+    return sizeof(CacheHeader) + (size_t)length * (2 * sizeof(int) + sizeof(Instruction) + 1);
+}
+
+// False when the path does not fit
+bool cache_path(const char *dir, uint64_t key, char *path, size_t size) {
+    int written = snprintf(path, size, "%s/%016llx.numo-cache", dir, (unsigned long long)key);
+    return written >= 0 && (size_t)written < size;
+}
+
+// Map the entry open on fd if it belongs to the loaded digits, else NULL
+unsigned char *map_cache_entry(NumoInterpreter *interp, int fd) {
+    struct stat st;
+    size_t size = cache_size(interp->code_length);
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != size) return NULL;
+    unsigned char *data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) return NULL;
+
+    int length = interp->code_length;
+    CacheHeader expected;
+    CacheHeader found;
+    cache_header(interp, &expected);
+    memcpy(&found, data, sizeof(found));
+    expected.payload_hash = found.payload_hash;
+    const unsigned char *jumps = data + sizeof(CacheHeader);
+    const unsigned char *ends = jumps + length * sizeof(int);
+    const unsigned char *program = ends + length * sizeof(int);
+    const unsigned char *code = program + length * sizeof(Instruction);
+    if (memcmp(&found, &expected, sizeof(CacheHeader)) != 0 ||
+        memcmp(code, interp->code, length) != 0 ||
+        cache_payload_hash(jumps, ends, program, length) != found.payload_hash) {
+        munmap(data, size);
+        return NULL;
+    }
+    return data;
+}
+
+// Copy the on-disk entry for the loaded digits in; false on any mismatch
+bool load_compile_cache(NumoInterpreter *interp) {
+    char path[PATH_MAX];
+    if (!cache_path(interp->cache_dir, cache_key(interp), path, sizeof(path))) return false;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    unsigned char *data = map_cache_entry(interp, fd);
+    close(fd);
+    if (!data) return false;
+
+    int length = interp->code_length;
+    const unsigned char *cursor = data + sizeof(CacheHeader);
+    memcpy(interp->jump_table, cursor, length * sizeof(int));
+    cursor += length * sizeof(int);
+    memcpy(interp->segment_end, cursor, length * sizeof(int));
+    cursor += length * sizeof(int);
+    memcpy(interp->program, cursor, length * sizeof(Instruction));
+    munmap(data, cache_size(length));
+    return true;
+}
+
+// Write the entry to a temporary file and rename it into place, so readers
+// in other processes never see half an entry
+bool store_compile_cache(NumoInterpreter *interp, const char *dir) {
+    CacheHeader header;
+    cache_header(interp, &header);
+    header.payload_hash = cache_payload_hash(interp->jump_table, interp->segment_end,
+                                             interp->program, interp->code_length);
+    char path[PATH_MAX];
+    char temp[PATH_MAX];
+    if (!cache_path(dir, header.key, path, sizeof(path))) return false;
+    int written = snprintf(temp, sizeof(temp), "%s.XXXXXX", path);
+    if (written < 0 || (size_t)written >= sizeof(temp)) return false;
+
+    if (mkdir(dir, 0777) != 0 && errno != EEXIST) return false;
+    int fd = mkstemp(temp);
+    if (fd < 0) return false;
+    int length = interp->code_length;
+    struct iovec iov[5] = {
+        { &header, sizeof(header) },
+        { interp->jump_table, length * sizeof(int) },
+        { interp->segment_end, length * sizeof(int) },
+        { interp->program, length * sizeof(Instruction) },
+        { interp->code, length },
+    };
+    size_t size = cache_size(length);
+    bool ok = writev(fd, iov, 5) == (ssize_t)size;
+    if (close(fd) != 0) ok = false;
+    if (ok) ok = rename(temp, path) == 0;
+    if (!ok) unlink(temp);
+    return ok;
+}
+
+// Drop the shared mapping (and its lock); compile into own arrays again
+void detach_shared_code(NumoInterpreter *interp) {
+    if (interp->shared_code) {
+        munmap(interp->shared_code, interp->shared_size);
+        close(interp->shared_fd);
+        interp->shared_code = NULL;
+    }
+    interp->program = interp->own_program;
+    interp->jump_table = interp->own_jump_table;
+    interp->segment_end = interp->own_segment_end;
+}
+
+// Point the interpreter at the /dev/shm entry for the loaded digits
+bool attach_shared_code(NumoInterpreter *interp) {
+    char path[PATH_MAX];
+    if (!cache_path(SHM_CACHE_DIR, cache_key(interp), path, sizeof(path))) return false;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    // Eviction takes the write lock before unlinking, so this fails only
+    // while an entry is being removed
+    struct flock lock = { .l_type = F_RDLCK, .l_whence = SEEK_SET };
+    unsigned char *data = NULL;
+    if (fcntl(fd, F_OFD_SETLK, &lock) == 0) {
+        data = map_cache_entry(interp, fd);
+    }
+    if (!data) {
+        close(fd);
+        return false;
+    }
+    futimens(fd, NULL); // last use, for eviction
+
+    int length = interp->code_length;
+    interp->shared_code = data;
+    interp->shared_size = cache_size(length);
+    interp->shared_fd = fd;
+    interp->jump_table = (int *)(data + sizeof(CacheHeader));
+    interp->segment_end = interp->jump_table + length;
+    interp->program = (Instruction *)(interp->segment_end + length);
+    return true;
+}
+
+typedef struct {
+    char name[NAME_MAX + 1];
+    struct timespec used;
+} ShmEntry;
+
+int compare_shm_entries(const void *a, const void *b) {
+    const struct timespec *x = &((const ShmEntry *)a)->used;
+    const struct timespec *y = &((const ShmEntry *)b)->used;
+    if (x->tv_sec != y->tv_sec) return x->tv_sec < y->tv_sec ? -1 : 1;
+    return (x->tv_nsec > y->tv_nsec) - (x->tv_nsec < y->tv_nsec);
+}
+
+// Remove least recently used entries beyond SHM_CACHE_ENTRIES, skipping
+// any that a running process still maps
+void evict_shared_code(void) {
+    DIR *dir = opendir(SHM_CACHE_DIR);
+    if (!dir) return;
+    ShmEntry *entries = NULL;
+    size_t count = 0, capacity = 0;
+    struct dirent *ent;
+    while ((ent = readdir(dir))) {
+        size_t len = strlen(ent->d_name);
+        if (len < 11 || strcmp(ent->d_name + len - 11, ".numo-cache") != 0) continue;
+        struct stat st;
+        if (fstatat(dirfd(dir), ent->d_name, &st, 0) != 0) continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 32;
+            ShmEntry *grown = realloc(entries, capacity * sizeof(ShmEntry));
+            if (!grown) break;
+            entries = grown;
+        }
+        memcpy(entries[count].name, ent->d_name, len + 1);
+        entries[count].used = st.st_mtim;
+        count++;
+    }
+    if (count > SHM_CACHE_ENTRIES) {
+        qsort(entries, count, sizeof(ShmEntry), compare_shm_entries);
+        size_t excess = count - SHM_CACHE_ENTRIES;
+        for (size_t i = 0; i < count && excess > 0; i++) {
+            int fd = openat(dirfd(dir), entries[i].name, O_RDWR);
+            if (fd < 0) continue;
+            struct flock lock = { .l_type = F_WRLCK, .l_whence = SEEK_SET };
+            if (fcntl(fd, F_OFD_SETLK, &lock) == 0 && unlinkat(dirfd(dir), entries[i].name, 0) == 0) {
+                excess--;
+            }
+            close(fd);
+        }
+    }
+    free(entries);
+    closedir(dir);
+}
+
+// Compile the loaded digits into the instruction stream, the jump table
+// and the pure segment ends, or take all three from a cache
+void build_program(NumoInterpreter *interp) {
+    detach_shared_code(interp);
+    if (interp->shm_cache && attach_shared_code(interp)) {
+        if (interp->debug_mode) {
+            fprintf(interp->out, BLUE "Shared compile cache hit in " SHM_CACHE_DIR "\n" RESET);
+        }
+        return;
+    }
+    if (interp->cache_dir && load_compile_cache(interp)) {
+        if (interp->debug_mode) {
+            fprintf(interp->out, BLUE "Compile cache hit in %s\n" RESET, interp->cache_dir);
+        }
+    } else {
+        for (int i = 0; i < interp->code_length; i++) {
+            interp->program[i] = decode_instruction(interp, i);
+        }
+        build_jump_table(interp);
+        analyze_segments(interp);
+        if (interp->cache_dir) {
+            bool stored = store_compile_cache(interp, interp->cache_dir);
+            if (interp->debug_mode) {
+                fprintf(interp->out, BLUE "Compile cache miss, %s %s\n" RESET,
+                        stored ? "stored in" : "cannot write", interp->cache_dir);
+            }
+        }
+    }
+    // This process keeps its own copy; the ones that follow map the entry
+    if (interp->shm_cache) {
+        bool stored = store_compile_cache(interp, SHM_CACHE_DIR);
+        if (stored) evict_shared_code();
+        if (interp->debug_mode) {
+            fprintf(interp->out, BLUE "Shared compile cache miss, %s " SHM_CACHE_DIR "\n" RESET,
+                    stored ? "stored in" : "cannot write");
+        }
+    }
+}
+
+// Build the program, then plan and allocate what its run needs
+void compile_program(NumoInterpreter *interp) {
+    build_program(interp);
+    plan_resources(interp, &interp->plan);
+    size_variable_store(interp);
+}
+
+// Compiled program container (.numc). After a 32-byte header come
+// segments, each a kind byte, a LEB128 digit count and its payload:
+//   NUMC_DIGITS  two digits per byte, first in the high nibble
+//   NUMC_BITS    a 0/1 run, eight digits per byte, first in the high bit
+//   NUMC_FILL    a run of one repeated digit, stored once
+// Header (little endian): "NUMC", version, 3 reserved bytes, digit count,
+// segment count, FNV-1a hash of the digits, digits in bit and fill runs.
+#define NUMC_MAGIC "NUMC"
+#define NUMC_VERSION 1
+#define NUMC_HEADER_SIZE 32
+#define NUMC_FILL_MIN 32  // repeats before a run is stored once
+#define NUMC_BITS_MIN 16  // 0/1 digits before a run is bit-packed
+
+enum { NUMC_DIGITS, NUMC_BITS, NUMC_FILL };
+
+typedef struct {
+    uint32_t digit_count;
+    uint32_t segment_count;
+    uint64_t hash;
+    uint32_t bit_digits;
+    uint32_t fill_digits;
+} NumcHeader;
+
+void put_le(unsigned char *out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+uint64_t get_le(const unsigned char *in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) value |= (uint64_t)in[i] << (8 * i);
+    return value;
+}
+
+size_t put_varint(unsigned char *out, size_t value) {
+    size_t n = 0;
+    do {
+        out[n++] = (unsigned char)((value & 0x7f) | (value >= 0x80 ? 0x80 : 0));
+        value >>= 7;
+    } while (value);
+    return n;
+}
+
+// False when the value runs past end or does not fit in 32 bits
+bool get_varint(const unsigned char **in, const unsigned char *end, size_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (*in >= end) return false;
+        unsigned char byte = *(*in)++;
+        *value |= (size_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return *value <= UINT32_MAX;
+    }
+    return false;
+}
+
+size_t same_run(const char *code, size_t from, size_t length) {
+    size_t end = from + 1;
+    while (end < length && code[end] == code[from]) end++;
+    return end - from;
+}
+
+// 0/1 digits from `from`, stopping before a run long enough to fill
+size_t bit_run(const char *code, size_t from, size_t length) {
+    size_t end = from;
+    while (end < length && (code[end] == '0' || code[end] == '1')) {
+        if (same_run(code, end, length) >= NUMC_FILL_MIN) break;
+        end++;
+    }
+    return end - from;
+}
+
+// Pack the loaded digits; the buffer is malloc'd, *size its length
+unsigned char *pack_numc(const char *code, size_t length, size_t *size, NumcHeader *header) {
+    // Worst case: every digit in its own nibble segment
+    unsigned char *out = malloc(NUMC_HEADER_SIZE + length * 7 + 16);
+    if (!out) return NULL;
+    memset(header, 0, sizeof(*header));
+    header->digit_count = length;
+    header->hash = hash_bytes(FNV_OFFSET, code, length);
+
+    size_t pos = NUMC_HEADER_SIZE;
+    size_t i = 0;
+    while (i < length) {
+        size_t run = same_run(code, i, length);
+        if (run >= NUMC_FILL_MIN) {
+            out[pos++] = NUMC_FILL;
+            pos += put_varint(out + pos, run);
+            out[pos++] = code[i] - '0';
+            header->fill_digits += run;
+            header->segment_count++;
+            i += run;
+            continue;
+        }
+        run = bit_run(code, i, length);
+        if (run >= NUMC_BITS_MIN) {
+            out[pos++] = NUMC_BITS;
+            pos += put_varint(out + pos, run);
+            memset(out + pos, 0, (run + 7) / 8);
+            for (size_t j = 0; j < run; j++) {
+                out[pos + j / 8] |= (code[i + j] == '1') << (7 - j % 8);
+            }
+            pos += (run + 7) / 8;
+            header->bit_digits += run;
+            header->segment_count++;
+            i += run;
+            continue;
+        }
+
+        // Plain digits up to where a fill or bit run starts
+        size_t end = i + 1;
+        while (end < length && same_run(code, end, length) < NUMC_FILL_MIN &&
+               bit_run(code, end, length) < NUMC_BITS_MIN) {
+            end++;
+        }
+        run = end - i;
+        out[pos++] = NUMC_DIGITS;
+        pos += put_varint(out + pos, run);
+        for (size_t j = 0; j < run; j += 2) {
+            unsigned high = code[i + j] - '0';
+            unsigned low = (j + 1 < run) ? code[i + j + 1] - '0' : 0;
+            out[pos++] = (unsigned char)(high << 4 | low);
+        }
+        header->segment_count++;
+        i = end;
+    }
+
+    memcpy(out, NUMC_MAGIC, 4);
+    out[4] = NUMC_VERSION;
+    out[5] = out[6] = out[7] = 0;
+    put_le(out + 8, header->digit_count, 4);
+    put_le(out + 12, header->segment_count, 4);
+    put_le(out + 16, header->hash, 8);
+    put_le(out + 24, header->bit_digits, 4);
+    put_le(out + 28, header->fill_digits, 4);
+    *size = pos;
+    return out;
+}
+
+// Unpack a container into code (room for `capacity` digits); false on a
+// malformed file or a hash mismatch
+bool unpack_numc(const unsigned char *data, size_t size, char *code, size_t capacity, NumcHeader *header) {
+    if (size < NUMC_HEADER_SIZE || memcmp(data, NUMC_MAGIC, 4) != 0 || data[4] != NUMC_VERSION) return false;
+    header->digit_count = get_le(data + 8, 4);
+    header->segment_count = get_le(data + 12, 4);
+    header->hash = get_le(data + 16, 8);
+    header->bit_digits = get_le(data + 24, 4);
+    header->fill_digits = get_le(data + 28, 4);
+    if (header->digit_count > capacity) return false;
+
+    const unsigned char *in = data + NUMC_HEADER_SIZE, *end = data + size;
+    size_t length = 0;
+    for (uint32_t s = 0; s < header->segment_count; s++) {
+        size_t run;
+        if (in >= end) return false;
+        int kind = *in++;
+        if (!get_varint(&in, end, &run) || run > header->digit_count - length) return false;
+        char *out = code + length;
+        switch (kind) {
+            case NUMC_DIGITS:
+                if ((size_t)(end - in) < (run + 1) / 2) return false;
+                for (size_t j = 0; j < run; j++) {
+                    unsigned digit = (j % 2) ? in[j / 2] & 0x0f : in[j / 2] >> 4;
+                    if (digit > 9) return false;
+                    out[j] = '0' + digit;
+                }
+                in += (run + 1) / 2;
+                break;
+            case NUMC_BITS:
+                if ((size_t)(end - in) < (run + 7) / 8) return false;
+                for (size_t j = 0; j < run; j++) {
+                    out[j] = '0' + ((in[j / 8] >> (7 - j % 8)) & 1);
+                }
+                in += (run + 7) / 8;
+                break;
+            case NUMC_FILL:
+                if (in >= end || *in > 9) return false;
+                memset(out, '0' + *in++, run);
+                break;
+            default:
+                return false;
+        }
+        length += run;
+    }
+    return length == header->digit_count && in == end &&
+           hash_bytes(FNV_OFFSET, code, length) == header->hash;
+}
+
+// True (file rewound) when the file starts with the container magic
+bool is_numc_file(FILE *file) {
+    char magic[4];
+    bool numc = fread(magic, 1, 4, file) == 4 && memcmp(magic, NUMC_MAGIC, 4) == 0;
+    rewind(file);
+    return numc;
+}
+
+// Load a .numc container: no digit filtering, just unpacking
+bool load_numc(NumoInterpreter *interp, FILE *file, const char *filename) {
+    unsigned char *data = NULL;
+    size_t size = 0, capacity = 0, got;
+    do {
+        if (size == capacity) {
+            capacity = capacity ? capacity * 2 : 4096;
+            unsigned char *grown = realloc(data, capacity);
+            if (!grown) break;
+            data = grown;
+        }
+        got = fread(data + size, 1, capacity - size, file);
+        size += got;
+    } while (got > 0);
+    fclose(file);
+
+    NumcHeader header;
+    bool ok = data && unpack_numc(data, size, interp->code, MAX_CODE_SIZE - 1, &header);
+    free(data);
+    if (!ok) {
+        fprintf(interp->out, RED "Error: Invalid or corrupt .numc file %s\n" RESET, filename);
+        return false;
+    }
+    interp->code[header.digit_count] = '\0';
+    interp->code_length = header.digit_count;
+    compile_program(interp);
+    if (interp->debug_mode) {
+        fprintf(interp->out, BLUE ".numc: %u segments, %u digits bit-packed, %u in fill runs, %zu bytes\n" RESET,
+                header.segment_count, header.bit_digits, header.fill_digits, size);
+    }
+    fprintf(interp->out, GREEN "Loaded Numo 0-9 program: %d digits\n" RESET, interp->code_length);
+    return true;
+}
+
+// --compile-numc: write the loaded program as a container
+bool write_numc(NumoInterpreter *interp, const char *filename) {
+    NumcHeader header;
+    size_t size;
+    unsigned char *data = pack_numc(interp->code, interp->code_length, &size, &header);
+    FILE *file = data ? fopen(filename, "wb") : NULL;
+    bool ok = file && fwrite(data, 1, size, file) == size;
+    if (file && fclose(file) != 0) ok = false;
+    free(data);
+    if (!ok) {
+        printf(RED "Error: Cannot write %s\n" RESET, filename);
+        return false;
+    }
+    printf(GREEN "Wrote %s: %d digits in %zu bytes (%.1f digits per byte), %u segments, %u digits bit-packed, %u in fill runs\n" RESET,
+           filename, interp->code_length, size, size ? (double)interp->code_length / size : 0.0,
+           header.segment_count, header.bit_digits, header.fill_digits);
+    return true;
+}
+
+// Load .num file, or a .numc container
+bool load_numo_file(NumoInterpreter *interp, const char *filename) {
+    FILE *file = fopen(filename, "r");
+    if (!file) {
+        fprintf(interp->out, RED "Error: Cannot open file %s\n" RESET, filename);
+        return false;
+    }
+    if (is_numc_file(file)) {
+        return load_numc(interp, file, filename);
+    }
+
+    char ch;
+    int i = 0;
+    while ((ch = fgetc(file)) != EOF && i < MAX_CODE_SIZE - 1) {
+        if (isdigit(ch)) {
+            interp->code[i++] = ch;
+        }
+    }
+    interp->code[i] = '\0';
+    interp->code_length = i;
+    fclose(file);
+    compile_program(interp);
+
+    fprintf(interp->out, GREEN "Loaded Numo 0-9 program: %d digits\n" RESET, interp->code_length);
+    return true;
+}
+
+// Set console color
+void set_color(NumoInterpreter *interp, int color_code) {
+    switch (color_code) {
+        case 0: strcpy(interp->current_color, RESET); break;
+        case 1: strcpy(interp->current_color, RED); break;
+        case 2: strcpy(interp->current_color, GREEN); break;
+        case 3: strcpy(interp->current_color, YELLOW); break;
+        case 4: strcpy(interp->current_color, BLUE); break;
+        case 5: strcpy(interp->current_color, MAGENTA); break;
+        case 6: strcpy(interp->current_color, CYAN); break;
+        case 7: strcpy(interp->current_color, WHITE); break;
+        case 8: strcpy(interp->current_color, BOLD); break;
+        case 9: strcpy(interp->current_color, RESET); break;
+    }
+}
+
+// Allocate a zeroed array owned by the run; NULL when out of memory
+NumArray *new_array(NumoInterpreter *interp, size_t length) {
+    NumArray *array = malloc(sizeof(NumArray));
+    size_t bytes = (length * sizeof(double) + 31) & ~(size_t)31;
+    double *data = aligned_alloc(32, bytes ? bytes : 32);
+    if (!array || !data) {
+        free(array);
+        free(data);
+        fprintf(interp->out, RED "Error: Cannot allocate array of %zu elements\n" RESET, length);
+        return NULL;
+    }
+    memset(data, 0, bytes);
+    array->length = length;
+    array->data = data;
+    array->next = interp->arrays;
+    interp->arrays = array;
+    return array;
+}
+
+// First elements of an array, then its length
+void print_array(FILE *out, const NumArray *array) {
+    fprintf(out, "[");
+    for (size_t i = 0; i < array->length && i < 10; i++) {
+        fprintf(out, "%s%g", i ? ", " : "", array->data[i]);
+    }
+    fprintf(out, "%s] (%zu elements)", array->length > 10 ? ", ..." : "", array->length);
+}
+
+// Create variable (type 3, 4, 5, 6, 7)
+void create_variable(NumoInterpreter *interp, int type, int position) {
+    if (interp->var_count >= interp->var_capacity) return;
+
+    Variable *var = &interp->vars[interp->var_count];
+    var->type = type;
+    char prefix[16];
+    snprintf(prefix, sizeof(prefix), "var_%d_", type);
+    name_variable(interp, var, prefix, position, "");
+
+    switch (type) {
+        case 3: // Numeric variable (integers)
+            // Look at the next digit to get the value
+            if (interp->position + 1 < interp->code_length) {
+                var->value.int_val = interp->code[interp->position + 1] - '0';
+            } else {
+                var->value.int_val = position % 10;
+            }
+            fprintf(interp->out, YELLOW "Created numeric variable %s = %lld\n" RESET, var->name, var->value.int_val);
+            break;
+        case 4: // Text string variable
+            snprintf(var->value.str_val.chars, STR_INLINE, "text_%d", position);
+            var->value.str_val.rope = NULL;
+            fprintf(interp->out, MAGENTA "Created text variable %s = \"%s\"\n" RESET, var->name, var->value.str_val.chars);
+            break;
+        case 5: // Boolean variable
+            var->value.bool_val = (position % 2 == 0);
+            fprintf(interp->out, BLUE "Created boolean variable %s = %s\n" RESET, var->name, 
+                   var->value.bool_val ? "true" : "false");
+            break;
+        case 6: // Float variable
+            var->value.float_val = (double)(position % 100) / 10.0;
+            fprintf(interp->out, GREEN "Created float variable %s = %.2f\n" RESET, var->name, var->value.float_val);
+            break;
+        case 7: // Array variable
+            var->value.array_val = new_array(interp, 5);
+            if (!var->value.array_val) return;
+            for (size_t i = 0; i < var->value.array_val->length; i++) {
+                var->value.array_val->data[i] = (position + i) % 10;
+            }
+            fprintf(interp->out, CYAN "Created array variable %s with %zu elements\n" RESET, var->name,
+                    var->value.array_val->length);
+            break;
+    }
+    interp->var_count++;
+}
+
+BigNum *big_new(int limbs) {
+    BigNum *big = calloc(1, sizeof(BigNum) + (size_t)(limbs > 0 ? limbs : 1) * sizeof(uint32_t));
+    if (big) big->len = limbs;
+    return big;
+}
+
+BigNum *big_copy(const BigNum *big) {
+    BigNum *copy = big_new(big->len);
+    if (!copy) return NULL;
+    memcpy(copy->limbs, big->limbs, big->len * sizeof(uint32_t));
+    copy->sign = big->sign;
+    return copy;
+}
+
+// Hand a result over to the interpreter so it lives as long as the run
+BigNum *big_adopt(NumoInterpreter *interp, BigNum *big) {
+    big->next = interp->bignums;
+    interp->bignums = big;
+    return big;
+}
+
+void big_normalize(BigNum *big) {
+    while (big->len > 0 && big->limbs[big->len - 1] == 0) big->len--;
+    if (big->len == 0) big->sign = 0;
+}
+
+BigNum *big_from_int(long long value) {
+    BigNum *big = big_new(3);
+    if (!big) return NULL;
+    unsigned long long magnitude = (value < 0) ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    big->sign = (value < 0) ? -1 : (value > 0);
+    for (int i = 0; i < 3; i++) {
+        big->limbs[i] = magnitude % BIG_BASE;
+        magnitude /= BIG_BASE;
+    }
+    big_normalize(big);
+    return big;
+}
+
+// False if the value does not fit a long long
+bool big_to_int(const BigNum *big, long long *value) {
+    if (big->len > 3) return false;
+    unsigned long long magnitude = 0;
+    for (int i = big->len - 1; i >= 0; i--) {
+        if (__builtin_mul_overflow(magnitude, BIG_BASE, &magnitude) ||
+            __builtin_add_overflow(magnitude, big->limbs[i], &magnitude)) {
+            return false;
+        }
+    }
+    if (big->sign >= 0) {
+        if (magnitude > (unsigned long long)LLONG_MAX) return false;
+        *value = (long long)magnitude;
+    } else {
+        if (magnitude > (unsigned long long)LLONG_MAX + 1) return false;
+        *value = (long long)(0ULL - magnitude);
+    }
+    return true;
+}
+
+double big_to_double(const BigNum *big) {
+    double value = 0;
+    for (int i = big->len - 1; i >= 0; i--) {
+        value = value * BIG_BASE + big->limbs[i];
+    }
+    return big->sign < 0 ? -value : value;
+}
+
+// Decimal text, caller frees
+char *big_to_string(const BigNum *big) {
+    char *text = malloc((size_t)big->len * BIG_DIGITS + 3);
+    if (!text) return NULL;
+    char *p = text;
+    if (big->sign < 0) *p++ = '-';
+    if (big->len == 0) {
+        strcpy(p, "0");
+        return text;
+    }
+    p += sprintf(p, "%u", big->limbs[big->len - 1]);
+    for (int i = big->len - 2; i >= 0; i--) {
+        uint32_t limb = big->limbs[i];
+        for (int d = BIG_DIGITS - 1; d >= 0; d--) {
+            p[d] = '0' + limb % 10;
+            limb /= 10;
+        }
+        p += BIG_DIGITS;
+    }
+    *p = '\0';
+    return text;
+}
+
+void print_bignum(FILE *out, const BigNum *big) {
+    char *text = big_to_string(big);
+    if (text) {
+        fputs(text, out);
+        free(text);
+    }
+}
+
+// Magnitude helpers on limb arrays
+int mag_compare(const uint32_t *a, int an, const uint32_t *b, int bn) {
+    if (an != bn) return an < bn ? -1 : 1;
+    for (int i = an - 1; i >= 0; i--) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// out = a + b, max(an, bn) + 1 limbs written
+void mag_add(const uint32_t *a, int an, const uint32_t *b, int bn, uint32_t *out) {
+    int len = an > bn ? an : bn;
+    uint32_t carry = 0;
+    for (int i = 0; i < len; i++) {
+        uint32_t sum = carry + (i < an ? a[i] : 0) + (i < bn ? b[i] : 0);
+        carry = sum >= BIG_BASE;
+        out[i] = carry ? sum - BIG_BASE : sum;
+    }
+    out[len] = carry;
+}
+
+// a += b; limbs of b past an must be zero
+void mag_add_in_place(uint32_t *a, int an, const uint32_t *b, int bn) {
+    uint32_t carry = 0;
+    int i = 0;
+    for (; i < an && (i < bn || carry); i++) {
+        uint32_t sum = a[i] + carry + (i < bn ? b[i] : 0);
+        carry = sum >= BIG_BASE;
+        a[i] = carry ? sum - BIG_BASE : sum;
+    }
+}
+
+// a -= b, requires a >= b
+void mag_sub_in_place(uint32_t *a, int an, const uint32_t *b, int bn) {
+    uint32_t borrow = 0;
+    for (int i = 0; i < an && (i < bn || borrow); i++) {
+        uint32_t sub = (i < bn ? b[i] : 0) + borrow;
+        borrow = a[i] < sub;
+        a[i] = borrow ? a[i] + BIG_BASE - sub : a[i] - sub;
+    }
+}
+
+// out += a * b, out has an + bn limbs
+void mag_mul_school(const uint32_t *a, int an, const uint32_t *b, int bn, uint32_t *out) {
+    for (int i = 0; i < an; i++) {
+        uint64_t carry = 0;
+        for (int j = 0; j < bn; j++) {
+            uint64_t cur = out[i + j] + (uint64_t)a[i] * b[j] + carry;
+            out[i + j] = cur % BIG_BASE;
+            carry = cur / BIG_BASE;
+        }
+        for (int k = i + bn; carry; k++) {
+            uint64_t cur = out[k] + carry;
+            out[k] = cur % BIG_BASE;
+            carry = cur / BIG_BASE;
+        }
+    }
+}
+
+// out (2n limbs) = a * b for n-limb operands: three half-size products
+// z0 = a0*b0, z2 = a1*b1, z1 = (a0+a1)(b0+b1) - z0 - z2
+void mag_karatsuba(const uint32_t *a, const uint32_t *b, int n, uint32_t *out) {
+    memset(out, 0, 2 * (size_t)n * sizeof(uint32_t));
+    int low = n / 2;
+    int high = n - low;
+    int sum_len = high + 1;
+    uint32_t *work = (n > KARATSUBA_CUTOFF) ? calloc(4 * (size_t)sum_len, sizeof(uint32_t)) : NULL;
+    if (!work) {
+        mag_mul_school(a, n, b, n, out);
+        return;
+    }
+
+    mag_karatsuba(a, b, low, out);
+    mag_karatsuba(a + low, b + low, high, out + 2 * low);
+
+    uint32_t *sum_a = work;
+    uint32_t *sum_b = work + sum_len;
+    uint32_t *middle = work + 2 * sum_len;
+    mag_add(a, low, a + low, high, sum_a);
+    mag_add(b, low, b + low, high, sum_b);
+    mag_karatsuba(sum_a, sum_b, sum_len, middle);
+    mag_sub_in_place(middle, 2 * sum_len, out, 2 * low);
+    mag_sub_in_place(middle, 2 * sum_len, out + 2 * low, 2 * high);
+    mag_add_in_place(out + low, 2 * n - low, middle, 2 * sum_len);
+    free(work);
+}
+
+// out (an + bn limbs, zeroed) = a * b
+void mag_mul(const uint32_t *a, int an, const uint32_t *b, int bn, uint32_t *out) {
+    int n = an > bn ? an : bn;
+    if ((an < bn ? an : bn) <= KARATSUBA_CUTOFF) {
+        mag_mul_school(a, an, b, bn, out);
+        return;
+    }
+    uint32_t *padded = calloc(4 * (size_t)n, sizeof(uint32_t));
+    if (!padded) {
+        mag_mul_school(a, an, b, bn, out);
+        return;
+    }
+    memcpy(padded, a, an * sizeof(uint32_t));
+    memcpy(padded + n, b, bn * sizeof(uint32_t));
+    mag_karatsuba(padded, padded + n, n, padded + 2 * n);
+    memcpy(out, padded + 2 * n, (size_t)(an + bn) * sizeof(uint32_t));
+    free(padded);
+}
+
+// x + sign * |y|; NULL when out of memory
+BigNum *big_add(const BigNum *x, const BigNum *y, int y_sign) {
+    int len = (x->len > y->len ? x->len : y->len) + 1;
+    BigNum *result = big_new(len);
+    if (!result) return NULL;
+    if (y_sign == 0 || x->sign == y_sign) {
+        mag_add(x->limbs, x->len, y->limbs, y->len, result->limbs);
+        result->sign = x->sign ? x->sign : y_sign;
+    } else if (x->sign == 0 || mag_compare(x->limbs, x->len, y->limbs, y->len) < 0) {
+        memcpy(result->limbs, y->limbs, y->len * sizeof(uint32_t));
+        mag_sub_in_place(result->limbs, y->len, x->limbs, x->len);
+        result->sign = y_sign;
+    } else {
+        memcpy(result->limbs, x->limbs, x->len * sizeof(uint32_t));
+        mag_sub_in_place(result->limbs, x->len, y->limbs, y->len);
+        result->sign = x->sign;
+    }
+    big_normalize(result);
+    return result;
+}
+
+// NULL when out of memory or past BIGNUM_MAX_LIMBS
+BigNum *big_mul(const BigNum *x, const BigNum *y) {
+    if (x->len + y->len > BIGNUM_MAX_LIMBS) return NULL;
+    BigNum *result = big_new(x->len + y->len);
+    if (!result) return NULL;
+    mag_mul(x->limbs, x->len, y->limbs, y->len, result->limbs);
+    result->sign = x->sign * y->sign;
+    big_normalize(result);
+    return result;
+}
+
+// base^exponent by squaring; NULL if the result would be too large
+BigNum *big_pow(const BigNum *base, long long exponent) {
+    if (base->len > 0) {
+        double digits = log10((double)base->limbs[base->len - 1]) + (double)BIG_DIGITS * (base->len - 1);
+        if (digits * (double)exponent / BIG_DIGITS + 1 > BIGNUM_MAX_LIMBS) return NULL;
+    }
+    BigNum *result = big_from_int(1);
+    BigNum *square = big_copy(base);
+    while (result && square && exponent > 0) {
+        if (exponent & 1) {
+            BigNum *next = big_mul(result, square);
+            free(result);
+            result = next;
+        }
+        exponent >>= 1;
+        if (exponent > 0) {
+            BigNum *next = big_mul(square, square);
+            free(square);
+            square = next;
+        }
+    }
+    free(square);
+    return result;
+}
+
+// Print an int or bignum variable's value
+void print_integer_variable(FILE *out, const Variable *var) {
+    if (var->type == 8) {
+        print_bignum(out, var->value.big_val);
+    } else {
+        fprintf(out, "%lld", var->value.int_val);
+    }
+}
+
+// Bignum path (--bignum) for add/sub/mul/pow when an int operation
+// overflows or an operand is already a bignum. Results that fit 64 bits
+// go back to ints. False leaves the operation to the float path.
+bool bignum_math(NumoInterpreter *interp, int operation, Variable *left, Variable *right, int position) {
+    if (operation > 2 && operation != 4) return false;
+    if (operation == 4 && (right->type != 3 || right->value.int_val < 0)) return false;
+
+    BigNum *left_temp = NULL, *right_temp = NULL;
+    BigNum *a = (left->type == 8) ? left->value.big_val : (left_temp = big_from_int(left->value.int_val));
+    BigNum *b = (right->type == 8) ? right->value.big_val : (right_temp = big_from_int(right->value.int_val));
+    BigNum *result = NULL;
+    const char *op_name = "";
+    char op_symbol = '?';
+
+    if (a && b) {
+        switch (operation) {
+            case 0: result = big_add(a, b, b->sign); op_name = "Addition"; op_symbol = '+'; break;
+            case 1: result = big_add(a, b, -b->sign); op_name = "Subtraction"; op_symbol = '-'; break;
+            case 2: result = big_mul(a, b); op_name = "Multiplication"; op_symbol = '*'; break;
+            case 4: result = big_pow(a, right->value.int_val); op_name = "Power"; op_symbol = '^'; break;
+        }
+    }
+    free(left_temp);
+    free(right_temp);
+    if (!result) {
+        fprintf(interp->out, RED "Warning: Bignum result too large, computing in floating point\n" RESET);
+        return false;
+    }
+
+    Variable stored;
+    long long small;
+    if (big_to_int(result, &small)) {
+        free(result);
+        stored.type = 3;
+        stored.value.int_val = small;
+    } else {
+        stored.type = 8;
+        stored.value.big_val = big_adopt(interp, result);
+    }
+
+    fprintf(interp->out, GREEN "%s: " , op_name);
+    print_integer_variable(interp->out, left);
+    fprintf(interp->out, " %c ", op_symbol);
+    print_integer_variable(interp->out, right);
+    fprintf(interp->out, " = ");
+    print_integer_variable(interp->out, &stored);
+    fprintf(interp->out, "\n" RESET);
+
+    if (interp->var_count < interp->var_capacity) {
+        Variable *var = &interp->vars[interp->var_count];
+        var->type = stored.type;
+        var->value = stored.value;
+        name_variable(interp, var, "result_", position, "");
+        fprintf(interp->out, CYAN "Result stored in variable %s = " , var->name);
+        print_integer_variable(interp->out, var);
+        fprintf(interp->out, "\n" RESET);
+        interp->var_count++;
+    }
+    return true;
+}
+
+// x^n by squaring, false on overflow
+bool int_pow(long long base, long long exponent, long long *result) {
+    long long value = 1;
+    while (exponent > 0) {
+        if ((exponent & 1) && __builtin_mul_overflow(value, base, &value)) return false;
+        exponent >>= 1;
+        if (exponent > 0 && __builtin_mul_overflow(base, base, &base)) return false;
+    }
+    *result = value;
+    return true;
+}
+
+// Integer fast path for two int operands: exact 64-bit results stored as
+// an int variable. Returns false (float path) for operations that need a
+// float: unary functions, inexact division, negative powers, overflow.
+bool integer_math(NumoInterpreter *interp, int operation, long long a, long long b, int position) {
+    long long result = 0;
+    const char *op_name;
+    char op_symbol;
+    bool ok = true;
+
+    switch (operation) {
+        case 0:
+            ok = !__builtin_add_overflow(a, b, &result);
+            op_name = "Addition";
+            op_symbol = '+';
+            break;
+        case 1:
+            ok = !__builtin_sub_overflow(a, b, &result);
+            op_name = "Subtraction";
+            op_symbol = '-';
+            break;
+        case 2:
+            ok = !__builtin_mul_overflow(a, b, &result);
+            op_name = "Multiplication";
+            op_symbol = '*';
+            break;
+        case 3:
+            if (b != 0 && ((a == LLONG_MIN && b == -1) || a % b != 0)) return false;
+            if (b != 0) {
+                result = a / b;
+            } else {
+                fprintf(interp->out, RED "Warning: Division by zero!\n" RESET);
+            }
+            op_name = "Division";
+            op_symbol = '/';
+            break;
+        case 4:
+            if (b < 0) return false;
+            ok = int_pow(a, b, &result);
+            op_name = "Power";
+            op_symbol = '^';
+            break;
+        case 9:
+            if (b == -1) {
+                result = 0; // LLONG_MIN % -1 traps
+            } else if (b != 0) {
+                result = a % b;
+            } else {
+                fprintf(interp->out, RED "Warning: Modulo by zero!\n" RESET);
+            }
+            op_name = "Modulo";
+            op_symbol = '%';
+            break;
+        default:
+            return false;
+    }
+    if (!ok) {
+        if (!interp->bignum_enabled) {
+            fprintf(interp->out, RED "Warning: Integer overflow, computing in floating point\n" RESET);
+        }
+        return false;
+    }
+
+    fprintf(interp->out, GREEN "%s: %lld %c %lld = %lld\n" RESET, op_name, a, op_symbol, b, result);
+    if (interp->var_count < interp->var_capacity) {
+        Variable *var = &interp->vars[interp->var_count];
+        var->type = 3; // Integer result
+        name_variable(interp, var, "result_", position, "");
+        var->value.int_val = result;
+        fprintf(interp->out, CYAN "Result stored in variable %s = %lld\n" RESET, var->name, result);
+        interp->var_count++;
+    }
+    return true;
+}
+
+// Elementwise kernels on 4-double vectors (32 bytes, one AVX register or
+// two SSE2 ones); each array job covers a range of elements
+typedef double v4d __attribute__((vector_size(32)));
+typedef long long v4l __attribute__((vector_size(32)));
+
+typedef struct {
+    int operation;
+    const double *left;
+    bool left_scalar;
+    const double *right;
+    bool right_scalar;
+    double *out;
+    size_t begin;
+    size_t end;
+} ArrayJob;
+
+// One element with the scalar path's semantics (left = older operand)
+double scalar_math(int operation, double left, double right) {
+    switch (operation) {
+        case 0: return left + right;
+        case 1: return left - right;
+        case 2: return left * right;
+        case 3: return right != 0 ? left / right : 0;
+        case 4: return pow(left, right);
+        case 5: return sqrt(right);
+        case 6: return sin(right);
+        case 7: return cos(right);
+        case 8: return right > 0 ? log(right) : 0;
+        case 9: return right != 0 ? fmod(left, right) : 0;
+    }
+    return 0;
+}
+
+// Vectors go through pointers so non-AVX builds keep the usual ABI
+void vector_sqrt(v4d *value) {
+#if defined(__AVX__)
+    *value = (v4d)_mm256_sqrt_pd((__m256d)*value);
+#elif defined(__SSE2__)
+    __m128d halves[2];
+    memcpy(halves, value, sizeof(*value));
+    halves[0] = _mm_sqrt_pd(halves[0]);
+    halves[1] = _mm_sqrt_pd(halves[1]);
+    memcpy(value, halves, sizeof(*value));
+#else
+    for (int k = 0; k < 4; k++) (*value)[k] = sqrt((*value)[k]);
+#endif
+}
+
+// fmod for integer-valued lanes below 2^53 through 64-bit integer
+// remainder (the sign bit of the dividend keeps fmod's -0); any other lane
+// sends the whole vector through fmod
+void vector_mod(v4d *out, const v4d *left_ptr, const v4d *right_ptr) {
+    v4d left = *left_ptr, right = *right_ptr;
+    const v4d limit = { 0x1p53, 0x1p53, 0x1p53, 0x1p53 };
+    const v4l sign_bit = { LLONG_MIN, LLONG_MIN, LLONG_MIN, LLONG_MIN };
+    v4l safe = ((v4d)((v4l)left & ~sign_bit) < limit) & ((v4d)((v4l)right & ~sign_bit) < limit) & (right != 0);
+    if (safe[0] && safe[1] && safe[2] && safe[3]) {
+        v4l left_int = __builtin_convertvector(left, v4l);
+        v4l right_int = __builtin_convertvector(right, v4l);
+        v4l exact = (__builtin_convertvector(left_int, v4d) == left) & (__builtin_convertvector(right_int, v4d) == right);
+        if (exact[0] && exact[1] && exact[2] && exact[3]) {
+            v4d result = __builtin_convertvector(left_int % right_int, v4d);
+            *out = (v4d)((v4l)result | ((v4l)left & sign_bit));
+            return;
+        }
+    }
+    for (int k = 0; k < 4; k++) (*out)[k] = scalar_math(9, left[k], right[k]);
+}
+
+void array_kernel(ArrayJob *job) {
+    size_t i = job->begin;
+    for (; i + 4 <= job->end; i += 4) {
+        v4d left = job->left_scalar ? (v4d){ job->left[0], job->left[0], job->left[0], job->left[0] }
+                                    : *(const v4d *)(job->left + i);
+        v4d right = job->right_scalar ? (v4d){ job->right[0], job->right[0], job->right[0], job->right[0] }
+                                      : *(const v4d *)(job->right + i);
+        v4d result;
+        switch (job->operation) {
+            case 0: result = left + right; break;
+            case 1: result = left - right; break;
+            case 2: result = left * right; break;
+            case 3: result = (v4d)((v4l)(left / right) & (right != 0)); break;
+            case 5: result = right; vector_sqrt(&result); break;
+            case 9: vector_mod(&result, &left, &right); break;
+            default:
+                for (int k = 0; k < 4; k++) result[k] = scalar_math(job->operation, left[k], right[k]);
+                break;
+        }
+        *(v4d *)(job->out + i) = result;
+    }
+    for (; i < job->end; i++) {
+        job->out[i] = scalar_math(job->operation, job->left[job->left_scalar ? 0 : i],
+                                  job->right[job->right_scalar ? 0 : i]);
+    }
+}
+
+void *array_worker(void *arg) {
+    array_kernel(arg);
+    return NULL;
+}
+
+// Threads for an array pass: one below ARRAY_PARALLEL_MIN elements, else
+// one per online CPU up to ARRAY_MAX_THREADS
+long array_threads(size_t length) {
+    if (length < ARRAY_PARALLEL_MIN) return 1;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1) threads = 1;
+    if (threads > ARRAY_MAX_THREADS) threads = ARRAY_MAX_THREADS;
+    return threads;
+}
+
+// Run count jobs of job_size bytes each, the first on the calling thread;
+// a job whose thread cannot start runs inline
+void run_parallel(void *(*worker)(void *), void *jobs, size_t job_size, long count) {
+    pthread_t ids[ARRAY_MAX_THREADS];
+    bool started[ARRAY_MAX_THREADS] = { false };
+    for (long t = 1; t < count; t++) {
+        started[t] = pthread_create(&ids[t], NULL, worker, (char *)jobs + t * job_size) == 0;
+    }
+    for (long t = 0; t < count; t++) {
+        if (t == 0 || !started[t]) worker((char *)jobs + t * job_size);
+    }
+    for (long t = 1; t < count; t++) {
+        if (started[t]) pthread_join(ids[t], NULL);
+    }
+}
+
+// Run a job over [0, end), split in 4-element aligned chunks across
+// threads once the array is large enough to be bandwidth bound
+void array_apply(ArrayJob job) {
+    size_t length = job.end;
+    long threads = array_threads(length);
+    ArrayJob jobs[ARRAY_MAX_THREADS];
+    size_t chunk = (length / threads + 3) & ~(size_t)3;
+    for (long t = 0; t < threads; t++) {
+        jobs[t] = job;
+        jobs[t].begin = t * chunk < length ? t * chunk : length;
+        jobs[t].end = (t + 1) * chunk < length && t + 1 < threads ? (t + 1) * chunk : length;
+    }
+    run_parallel(array_worker, jobs, sizeof(ArrayJob), threads);
+}
+
+// Reductions over arrays. Partials are taken per block and combined in a
+// fixed pairwise tree, so results do not depend on the thread count.
+#define ARRAY_REDUCE_BLOCK 4096
+
+typedef enum { REDUCE_SUM, REDUCE_MIN, REDUCE_MAX, REDUCE_DOT } ReduceKind;
+
+typedef struct {
+    ReduceKind kind;
+    const double *left;
+    const double *right;
+    size_t length;
+    double *partials;
+    size_t first_block;
+    size_t end_block;
+} ReduceJob;
+
+// min/max skip NaN like fmin/fmax: NaN only when every value is NaN
+double reduce_pair(ReduceKind kind, double a, double b) {
+    switch (kind) {
+        case REDUCE_MIN: return fmin(a, b);
+        case REDUCE_MAX: return fmax(a, b);
+        default: return a + b;
+    }
+}
+
+double reduce_identity(ReduceKind kind) {
+    return (kind == REDUCE_MIN || kind == REDUCE_MAX) ? NAN : 0.0;
+}
+
+double reduce_block(ReduceKind kind, const double *left, const double *right, size_t begin, size_t end) {
+    double identity = reduce_identity(kind);
+    v4d acc = { identity, identity, identity, identity };
+    size_t i = begin;
+    switch (kind) {
+        case REDUCE_SUM:
+            for (; i + 4 <= end; i += 4) acc += *(const v4d *)(left + i);
+            break;
+        case REDUCE_DOT:
+            for (; i + 4 <= end; i += 4) acc += *(const v4d *)(left + i) * *(const v4d *)(right + i);
+            break;
+        case REDUCE_MIN:
+            for (; i + 4 <= end; i += 4) {
+                v4d value = *(const v4d *)(left + i);
+                v4l take = (value < acc) | (acc != acc);
+                acc = (v4d)(((v4l)value & take) | ((v4l)acc & ~take));
+            }
+            break;
+        case REDUCE_MAX:
+            for (; i + 4 <= end; i += 4) {
+                v4d value = *(const v4d *)(left + i);
+                v4l take = (value > acc) | (acc != acc);
+                acc = (v4d)(((v4l)value & take) | ((v4l)acc & ~take));
+            }
+            break;
+    }
+    double result = reduce_pair(kind, reduce_pair(kind, acc[0], acc[1]), reduce_pair(kind, acc[2], acc[3]));
+    for (; i < end; i++) {
+        result = reduce_pair(kind, result, (kind == REDUCE_DOT) ? left[i] * right[i] : left[i]);
+    }
+    return result;
+}
+
+void *reduce_worker(void *arg) {
+    ReduceJob *job = arg;
+    for (size_t b = job->first_block; b < job->end_block; b++) {
+        size_t begin = b * ARRAY_REDUCE_BLOCK;
+        size_t end = begin + ARRAY_REDUCE_BLOCK < job->length ? begin + ARRAY_REDUCE_BLOCK : job->length;
+        job->partials[b] = reduce_block(job->kind, job->left, job->right, begin, end);
+    }
+    return NULL;
+}
+
+// Reduce length elements (right only for REDUCE_DOT)
+double array_reduce(ReduceKind kind, const double *left, const double *right, size_t length) {
+    size_t blocks = (length + ARRAY_REDUCE_BLOCK - 1) / ARRAY_REDUCE_BLOCK;
+    if (blocks == 0) return reduce_identity(kind);
+    double *partials = malloc(blocks * sizeof(double));
+    if (!partials) return reduce_block(kind, left, right, 0, length);
+
+    long threads = array_threads(length);
+    if ((size_t)threads > blocks) threads = blocks;
+    ReduceJob jobs[ARRAY_MAX_THREADS];
+    size_t per_thread = (blocks + threads - 1) / threads;
+    for (long t = 0; t < threads; t++) {
+        jobs[t] = (ReduceJob){ kind, left, right, length, partials, 0, 0 };
+        jobs[t].first_block = t * per_thread < blocks ? t * per_thread : blocks;
+        jobs[t].end_block = (t + 1) * per_thread < blocks ? (t + 1) * per_thread : blocks;
+    }
+    run_parallel(reduce_worker, jobs, sizeof(ReduceJob), threads);
+
+    for (size_t width = 1; width < blocks; width *= 2) {
+        for (size_t b = 0; b + width < blocks; b += 2 * width) {
+            partials[b] = reduce_pair(kind, partials[b], partials[b + width]);
+        }
+    }
+    double result = partials[0];
+    free(partials);
+    return result;
+}
+
+// NaN sorts last
+int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    if (isnan(x) || isnan(y)) return isnan(x) - isnan(y);
+    return (x > y) - (x < y);
+}
+
+// LSD radix sort on order-preserving 64-bit keys of the doubles, 8 bits
+// per pass; passes where every key has the same byte are skipped, which
+// leaves only a few for small integers
+bool radix_sort_doubles(double *data, size_t length) {
+    uint64_t *keys = malloc(length * sizeof(uint64_t));
+    uint64_t *scratch = malloc(length * sizeof(uint64_t));
+    size_t (*counts)[256] = calloc(8, sizeof(*counts));
+    if (!keys || !scratch || !counts) {
+        free(keys);
+        free(scratch);
+        free(counts);
+        return false;
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        uint64_t bits;
+        memcpy(&bits, &data[i], sizeof(bits));
+        keys[i] = (bits >> 63) ? ~bits : bits | (1ULL << 63);
+        for (int pass = 0; pass < 8; pass++) {
+            counts[pass][(keys[i] >> (pass * 8)) & 0xff]++;
+        }
+    }
+    for (int pass = 0; pass < 8; pass++) {
+        int shift = pass * 8;
+        if (counts[pass][(keys[0] >> shift) & 0xff] == length) continue;
+        size_t offset = 0;
+        for (int d = 0; d < 256; d++) {
+            size_t count = counts[pass][d];
+            counts[pass][d] = offset;
+            offset += count;
+        }
+        for (size_t i = 0; i < length; i++) {
+            scratch[counts[pass][(keys[i] >> shift) & 0xff]++] = keys[i];
+        }
+        uint64_t *swap = keys;
+        keys = scratch;
+        scratch = swap;
+    }
+    for (size_t i = 0; i < length; i++) {
+        uint64_t bits = (keys[i] >> 63) ? keys[i] & ~(1ULL << 63) : ~keys[i];
+        memcpy(&data[i], &bits, sizeof(bits));
+    }
+    free(keys);
+    free(scratch);
+    free(counts);
+    return true;
+}
+
+typedef struct {
+    const double *from;
+    double *to;
+    size_t begin;
+    size_t middle;
+    size_t end;
+} MergeJob;
+
+void *sort_chunk_worker(void *arg) {
+    MergeJob *job = arg;
+    qsort(job->to + job->begin, job->end - job->begin, sizeof(double), compare_doubles);
+    return NULL;
+}
+
+void *merge_worker(void *arg) {
+    MergeJob *job = arg;
+    size_t i = job->begin, j = job->middle, k = job->begin;
+    while (i < job->middle && j < job->end) {
+        job->to[k++] = (compare_doubles(&job->from[j], &job->from[i]) < 0) ? job->from[j++] : job->from[i++];
+    }
+    while (i < job->middle) job->to[k++] = job->from[i++];
+    while (j < job->end) job->to[k++] = job->from[j++];
+    return NULL;
+}
+
+// Chunks sorted on separate threads, then merged pairwise, each round's
+// merges running in parallel
+bool merge_sort_doubles(double *data, size_t length) {
+    long threads = array_threads(length);
+    if (threads == 1) {
+        qsort(data, length, sizeof(double), compare_doubles);
+        return true;
+    }
+    double *scratch = malloc(length * sizeof(double));
+    if (!scratch) return false;
+
+    MergeJob jobs[ARRAY_MAX_THREADS];
+    size_t width = (length + threads - 1) / threads;
+    for (long t = 0; t < threads; t++) {
+        size_t begin = t * width < length ? t * width : length;
+        size_t end = begin + width < length ? begin + width : length;
+        jobs[t] = (MergeJob){ data, data, begin, end, end };
+    }
+    run_parallel(sort_chunk_worker, jobs, sizeof(MergeJob), threads);
+
+    double *from = data, *to = scratch;
+    for (; width < length; width *= 2) {
+        long count = 0;
+        for (size_t begin = 0; begin < length; begin += 2 * width) {
+            size_t middle = begin + width < length ? begin + width : length;
+            size_t end = middle + width < length ? middle + width : length;
+            jobs[count++] = (MergeJob){ from, to, begin, middle, end };
+        }
+        run_parallel(merge_worker, jobs, sizeof(MergeJob), count);
+        double *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != data) memcpy(data, from, length * sizeof(double));
+    free(scratch);
+    return true;
+}
+
+// Sort an array in place: radix when every element is an integer, merge
+// sort otherwise. Returns the method used.
+const char *sort_array(NumArray *array) {
+    if (array->length < 2) return "radix";
+    bool integral = true;
+    for (size_t i = 0; i < array->length && integral; i++) {
+        integral = array->data[i] == floor(array->data[i]);
+    }
+    if (integral && radix_sort_doubles(array->data, array->length)) return "radix";
+    if (!merge_sort_doubles(array->data, array->length)) {
+        qsort(array->data, array->length, sizeof(double), compare_doubles);
+    }
+    return "merge";
+}
+
+// Binary payloads: 8 digits per byte, '1' a set bit and any other digit
+// a clear one. Printable ASCII is kept, NUL shows as a space and other
+// bytes are dropped; a trailing partial byte is ignored.
+#define BINARY_PARALLEL_MIN (1 << 20)  // digits before a payload is split across threads
+
+typedef struct {
+    const char *digits;
+    size_t length;      // digits, a multiple of 8
+    char *out;          // room for length / 8 bytes
+    size_t out_length;  // bytes kept
+} DecodeJob;
+
+// Packs 8 digits at a time: bytes equal to '1' become 0x80, and a multiply
+// gathers their high bits, first digit into the top bit
+unsigned decode_byte(const char *digits) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t word;
+    memcpy(&word, digits, sizeof(word));
+    uint64_t diff = word ^ 0x3131313131313131ULL;
+    uint64_t zero = ~(((diff & 0x7f7f7f7f7f7f7f7fULL) + 0x7f7f7f7f7f7f7f7fULL) | diff | 0x7f7f7f7f7f7f7f7fULL);
+    return (unsigned)(((zero >> 7) * 0x8040201008040201ULL) >> 56);
+#else
+    unsigned value = 0;
+    for (int j = 0; j < 8; j++) value = (value << 1) | (digits[j] == '1');
+    return value;
+#endif
+}
+
+void *decode_worker(void *arg) {
+    DecodeJob *job = arg;
+    char *out = job->out;
+    for (size_t i = 0; i + 8 <= job->length; i += 8) {
+        unsigned value = decode_byte(job->digits + i);
+        *out = (value == 0) ? ' ' : (char)value;
+        out += (value == 0 || (value >= 32 && value <= 126));
+    }
+    job->out_length = out - job->out;
+    return NULL;
+}
+
+// Decode a payload into out (length / 8 bytes), in byte-aligned chunks on
+// separate threads once it is large; each chunk fills its own slice of
+// out, so the kept bytes are the jobs' slices in order. Returns the count.
+long decode_payload(const char *digits, size_t length, char *out, DecodeJob *jobs) {
+    size_t bytes = length / 8;
+    long threads = (length < BINARY_PARALLEL_MIN) ? 1 : array_threads(length);
+    size_t chunk = (bytes + threads - 1) / threads;
+    for (long t = 0; t < threads; t++) {
+        size_t begin = (t * chunk < bytes) ? t * chunk : bytes;
+        size_t end = ((t + 1) * chunk < bytes) ? (t + 1) * chunk : bytes;
+        jobs[t].digits = digits + begin * 8;
+        jobs[t].length = (end - begin) * 8;
+        jobs[t].out = out + begin;
+        jobs[t].out_length = 0;
+    }
+    run_parallel(decode_worker, jobs, sizeof(DecodeJob), threads);
+    return threads;
+}
+
+// Execute binary code (0s and 1s)
+void execute_binary(NumoInterpreter *interp, int start, int end) {
+    fprintf(interp->out, CYAN "Executing binary sequence from position %s to %s\n" RESET,
+            pos_text(interp, start), pos_text(interp, end));
+
+    fprintf(interp->out, "%s", interp->current_color);
+    char *decoded = malloc((end - start) / 8 + 1);
+    if (decoded) {
+        DecodeJob jobs[ARRAY_MAX_THREADS];
+        long count = decode_payload(interp->code + start, end - start, decoded, jobs);
+        for (long t = 0; t < count; t++) {
+            fwrite(jobs[t].out, 1, jobs[t].out_length, interp->out);
+        }
+        free(decoded);
+    }
+    fprintf(interp->out, RESET "\n");
+    fflush(interp->out); // Force output
+}
+
+// Payloads of a program file of any size, as a straight run would see
+// them: a 0 or 1 opens one, the next 2 closes it, the end of the file
+// closes the last. Stores digit ranges as (start, end) pairs.
+size_t find_payloads(const char *digits, size_t length, size_t **ranges) {
+    size_t count = 0, capacity = 0;
+    size_t start = SIZE_MAX;
+    *ranges = NULL;
+    for (size_t i = 0; i <= length; i++) {
+        bool closes = (i == length) ? start != SIZE_MAX : digits[i] == '2' && start != SIZE_MAX;
+        if (closes) {
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 64;
+                size_t *grown = realloc(*ranges, capacity * 2 * sizeof(size_t));
+                if (!grown) return count;
+                *ranges = grown;
+            }
+            (*ranges)[2 * count] = start;
+            (*ranges)[2 * count + 1] = i;
+            count++;
+            start = SIZE_MAX;
+        } else if (i < length && (digits[i] == '0' || digits[i] == '1') && start == SIZE_MAX) {
+            start = i;
+        }
+    }
+    return count;
+}
+
+// Write every decoded slice, then a newline per payload, with as few
+// writev calls as IOV_MAX allows
+bool write_slices(int fd, struct iovec *iov, size_t count) {
+    while (count > 0) {
+        int batch = (count < IOV_MAX) ? (int)count : IOV_MAX;
+        ssize_t written = writev(fd, iov, batch);
+        if (written < 0) return false;
+        // Skip what went out; a short write resumes inside an iovec
+        while (count > 0 && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+    return true;
+}
+
+// --decode-to: decode all payloads of a program file without running it,
+// to stdout ("-") through writev or into a memory-mapped output file.
+// Reads the whole file, so it is not bound by MAX_CODE_SIZE.
+bool decode_program_file(const char *source, const char *target) {
+    FILE *file = fopen(source, "rb");
+    if (!file) {
+        fprintf(stderr, RED "Error: Cannot open file %s\n" RESET, source);
+        return false;
+    }
+    size_t length = 0, capacity = 1 << 16;
+    char *digits = malloc(capacity);
+    char chunk[1 << 16];
+    size_t got;
+    while (digits && (got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        if (length + got > capacity) {
+            while (length + got > capacity) capacity *= 2;
+            char *grown = realloc(digits, capacity);
+            if (!grown) {
+                free(digits);
+                digits = NULL;
+                break;
+            }
+            digits = grown;
+        }
+        for (size_t i = 0; i < got; i++) {
+            digits[length] = chunk[i];
+            length += isdigit((unsigned char)chunk[i]) != 0;
+        }
+    }
+    fclose(file);
+    if (!digits) {
+        fprintf(stderr, RED "Error: Cannot read %s\n" RESET, source);
+        return false;
+    }
+
+    size_t *ranges;
+    size_t payloads = find_payloads(digits, length, &ranges);
+    char *decoded = malloc(length / 8 + 1);
+    DecodeJob *jobs = malloc((payloads ? payloads : 1) * ARRAY_MAX_THREADS * sizeof(DecodeJob));
+    long *counts = malloc((payloads ? payloads : 1) * sizeof(long));
+    struct iovec *iov = malloc((payloads ? payloads : 1) * (ARRAY_MAX_THREADS + 1) * sizeof(struct iovec));
+    bool ok = decoded && jobs && counts && iov;
+
+    // Payloads are disjoint, so each decodes into its own part of decoded
+    size_t slices = 0, total = 0;
+    for (size_t p = 0; ok && p < payloads; p++) {
+        size_t start = ranges[2 * p], end = ranges[2 * p + 1];
+        DecodeJob *payload_jobs = jobs + p * ARRAY_MAX_THREADS;
+        counts[p] = decode_payload(digits + start, end - start, decoded + start / 8, payload_jobs);
+        for (long t = 0; t < counts[p]; t++) {
+            if (payload_jobs[t].out_length == 0) continue;
+            iov[slices].iov_base = payload_jobs[t].out;
+            iov[slices++].iov_len = payload_jobs[t].out_length;
+            total += payload_jobs[t].out_length;
+        }
+        iov[slices].iov_base = "\n";
+        iov[slices++].iov_len = 1;
+        total++;
+    }
+
+    if (ok && strcmp(target, "-") == 0) {
+        fflush(stdout);
+        ok = write_slices(STDOUT_FILENO, iov, slices);
+    } else if (ok) {
+        int fd = open(target, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        char *mapped = MAP_FAILED;
+        ok = fd >= 0 && ftruncate(fd, total) == 0;
+        if (ok && total > 0) {
+            mapped = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ok = mapped != MAP_FAILED;
+        }
+        for (size_t i = 0, offset = 0; ok && i < slices; offset += iov[i].iov_len, i++) {
+            memcpy(mapped + offset, iov[i].iov_base, iov[i].iov_len);
+        }
+        if (mapped != MAP_FAILED) munmap(mapped, total);
+        if (fd >= 0) close(fd);
+        if (ok) {
+            printf(GREEN "Decoded %zu payloads (%zu digits) into %s: %zu bytes\n" RESET, payloads, length, target, total);
+        }
+    }
+    if (!ok) fprintf(stderr, RED "Error: Cannot decode %s to %s\n" RESET, source, target);
+    free(digits);
+    free(ranges);
+    free(decoded);
+    free(jobs);
+    free(counts);
+    free(iov);
+    return ok;
+}
+
+double variable_number(const Variable *var) {
+    switch (var->type) {
+        case 3: return (double)var->value.int_val;
+        case 8: return big_to_double(var->value.big_val);
+        default: return var->value.float_val;
+    }
+}
+
+void print_operand(FILE *out, const Variable *var) {
+    if (var->type == 7) {
+        fprintf(out, "array[%zu]", var->value.array_val->length);
+    } else {
+        fprintf(out, "%.2f", variable_number(var));
+    }
+}
+
+// Numeric array (--arrays, digit 3 before a 7): length from the most
+// recent int variable (5 without one), elements (position + i) % 10
+void create_array_variable(NumoInterpreter *interp, int position) {
+    if (interp->var_count >= interp->var_capacity) return;
+
+    long long length = 5;
+    for (int i = interp->var_count - 1; i >= 0; i--) {
+        if (interp->vars[i].type == 3) {
+            if (interp->vars[i].value.int_val > 0) length = interp->vars[i].value.int_val;
+            break;
+        }
+    }
+    if (length > ARRAY_MAX_LENGTH) {
+        fprintf(interp->out, RED "Warning: Array length %lld capped at %d\n" RESET, length, ARRAY_MAX_LENGTH);
+        length = ARRAY_MAX_LENGTH;
+    }
+
+    NumArray *array = new_array(interp, (size_t)length);
+    if (!array) return;
+    for (size_t i = 0; i < array->length; i++) {
+        array->data[i] = (double)((position + i) % 10);
+    }
+
+    Variable *var = &interp->vars[interp->var_count];
+    var->type = 7;
+    name_variable(interp, var, "array_var_", position, "");
+    var->value.array_val = array;
+    fprintf(interp->out, CYAN "Created ARRAY variable %s = " RESET, var->name);
+    print_array(interp->out, array);
+    fprintf(interp->out, "\n");
+    interp->var_count++;
+}
+
+// Digit-8 operation with an array operand, applied elementwise; a scalar
+// operand is broadcast and arrays of different lengths use the shorter
+void array_math(NumoInterpreter *interp, int operation, Variable *left, Variable *right, int position) {
+    static const char *names[] = { "Addition", "Subtraction", "Multiplication", "Division", "Power",
+                                   "Square root", "Sine", "Cosine", "Logarithm", "Modulo" };
+    static const char symbols[] = "+-*/^?????%";
+    bool unary = operation >= 5 && operation <= 8;
+    double left_value = (left->type == 7) ? 0 : variable_number(left);
+    double right_value = (right->type == 7) ? 0 : variable_number(right);
+
+    ArrayJob job = { operation, &left_value, true, &right_value, true, NULL, 0, 0 };
+    size_t length = SIZE_MAX;
+    if (left->type == 7 && !unary) {
+        job.left = left->value.array_val->data;
+        job.left_scalar = false;
+        length = left->value.array_val->length;
+    }
+    if (right->type == 7) {
+        job.right = right->value.array_val->data;
+        job.right_scalar = false;
+        if (length != SIZE_MAX && length != right->value.array_val->length) {
+            fprintf(interp->out, RED "Warning: Array lengths differ (%zu and %zu)\n" RESET,
+                    length, right->value.array_val->length);
+        }
+        if (right->value.array_val->length < length) length = right->value.array_val->length;
+    }
+
+    if (unary) {
+        fprintf(interp->out, GREEN "%s(", names[operation]);
+        print_operand(interp->out, right);
+    } else {
+        fprintf(interp->out, GREEN "%s: ", names[operation]);
+        print_operand(interp->out, left);
+        fprintf(interp->out, " %c ", symbols[operation == 9 ? 10 : operation]);
+        print_operand(interp->out, right);
+    }
+    fprintf(interp->out, "%s elementwise\n" RESET, unary ? ")" : "");
+
+    if (interp->var_count >= interp->var_capacity) return;
+    NumArray *result = new_array(interp, length);
+    if (!result) return;
+    job.out = result->data;
+    job.end = length;
+    array_apply(job);
+
+    Variable *var = &interp->vars[interp->var_count];
+    var->type = 7;
+    name_variable(interp, var, "result_", position, "");
+    var->value.array_val = result;
+    fprintf(interp->out, CYAN "Result stored in variable %s = " RESET, var->name);
+    print_array(interp->out, result);
+    fprintf(interp->out, "\n");
+    interp->var_count++;
+}
+
+// Store a reduction result as a float variable, like the math results
+void store_reduction(NumoInterpreter *interp, double result, int position) {
+    if (interp->var_count >= interp->var_capacity) return;
+    Variable *var = &interp->vars[interp->var_count];
+    var->type = 6;
+    name_variable(interp, var, "result_", position, "");
+    var->value.float_val = result;
+    fprintf(interp->out, CYAN "Result stored in variable %s = %.2f\n" RESET, var->name, result);
+    interp->var_count++;
+}
+
+// Reductions on the most recent variable when it is an array: 76 sum,
+// 86 min, 96 max, 06 mean. False when there is no such array.
+bool reduce_last_array(NumoInterpreter *interp, int prev_digit, int position) {
+    if (interp->var_count == 0 || interp->vars[interp->var_count - 1].type != 7) return false;
+    Variable *var = &interp->vars[interp->var_count - 1];
+    NumArray *array = var->value.array_val;
+
+    const char *name;
+    double result;
+    switch (prev_digit) {
+        case 7: name = "Sum"; result = array_reduce(REDUCE_SUM, array->data, NULL, array->length); break;
+        case 8: name = "Min"; result = array_reduce(REDUCE_MIN, array->data, NULL, array->length); break;
+        case 9: name = "Max"; result = array_reduce(REDUCE_MAX, array->data, NULL, array->length); break;
+        default:
+            name = "Mean";
+            result = array->length ? array_reduce(REDUCE_SUM, array->data, NULL, array->length) / array->length : 0;
+            break;
+    }
+    fprintf(interp->out, GREEN "%s of %s (%zu elements) = %g\n" RESET, name, var->name, array->length, result);
+    store_reduction(interp, result, position);
+    return true;
+}
+
+// Dot product (72) of the two most recent numeric operands when both are
+// arrays, over the shorter length
+bool array_dot_product(NumoInterpreter *interp, int position) {
+    Variable *operands[2] = { NULL, NULL };
+    int found_vars = 0;
+    for (int i = interp->var_count - 1; i >= 0 && found_vars < 2; i--) {
+        int type = interp->vars[i].type;
+        if (type == 3 || type == 6 || type == 7 || type == 8) {
+            operands[found_vars++] = &interp->vars[i];
+        }
+    }
+    if (found_vars < 2 || operands[0]->type != 7 || operands[1]->type != 7) return false;
+
+    NumArray *left = operands[1]->value.array_val;
+    NumArray *right = operands[0]->value.array_val;
+    size_t length = left->length < right->length ? left->length : right->length;
+    if (left->length != right->length) {
+        fprintf(interp->out, RED "Warning: Array lengths differ (%zu and %zu)\n" RESET, left->length, right->length);
+    }
+    double result = array_reduce(REDUCE_DOT, left->data, right->data, length);
+    fprintf(interp->out, GREEN "Dot product: %s . %s = %g\n" RESET, operands[1]->name, operands[0]->name, result);
+    store_reduction(interp, result, position);
+    return true;
+}
+
+// In-place sort (62) of the most recent variable when it is an array
+bool sort_last_array(NumoInterpreter *interp) {
+    if (interp->var_count == 0 || interp->vars[interp->var_count - 1].type != 7) return false;
+    Variable *var = &interp->vars[interp->var_count - 1];
+    const char *method = sort_array(var->value.array_val);
+    fprintf(interp->out, GREEN "Sorted %s (%s) = " RESET, var->name, method);
+    print_array(interp->out, var->value.array_val);
+    fprintf(interp->out, "\n");
+    return true;
+}
+
+// Advanced mathematical operations - FIXED
+void handle_advanced_math(NumoInterpreter *interp, int operation, int position) {
+    if (interp->var_count < 2) {
+        fprintf(interp->out, RED "Error: Need at least 2 variables for math operation\n" RESET);
+        return;
+    }
+
+    double val1 = 0, val2 = 0;
+    Variable *operands[2] = { NULL, NULL };
+    int found_vars = 0;
+
+    // Get the last two numeric variables
+    for (int i = interp->var_count - 1; i >= 0 && found_vars < 2; i--) {
+        int type = interp->vars[i].type;
+        if (type == 3 || type == 6 || type == 7 || type == 8) {
+            double value = (type == 7) ? 0 : variable_number(&interp->vars[i]);
+
+            if (found_vars == 0) {
+                val1 = value; // Most recent variable
+            } else if (found_vars == 1) {
+                val2 = value; // Second most recent variable
+            }
+            operands[found_vars] = &interp->vars[i];
+            found_vars++;
+        }
+    }
+
+    if (found_vars < 2) {
+        fprintf(interp->out, RED "Error: Not enough numeric variables for operation\n" RESET);
+        return;
+    }
+
+    if (operands[0]->type == 7 || (operands[1]->type == 7 && (operation <= 4 || operation == 9))) {
+        array_math(interp, operation, operands[1], operands[0], position);
+        return;
+    }
+    if (operands[0]->type == 3 && operands[1]->type == 3 &&
+        integer_math(interp, operation, operands[1]->value.int_val, operands[0]->value.int_val, position)) {
+        return;
+    }
+    if (interp->bignum_enabled && (operands[0]->type == 3 || operands[0]->type == 8) &&
+        (operands[1]->type == 3 || operands[1]->type == 8) &&
+        bignum_math(interp, operation, operands[1], operands[0], position)) {
+        return;
+    }
+
+    double result = 0;
+    char op_name[20];
+    char op_symbol = '?';
+
+    switch (operation) {
+        case 0: // Addition
+            result = val2 + val1;
+            strcpy(op_name, "Addition");
+            op_symbol = '+';
+            break;
+        case 1: // Subtraction
+            result = val2 - val1;
+            strcpy(op_name, "Subtraction");
+            op_symbol = '-';
+            break;
+        case 2: // Multiplication
+            result = val2 * val1;
+            strcpy(op_name, "Multiplication");
+            op_symbol = '*';
+            break;
+        case 3: // Division
+            if (val1 != 0) {
+                result = val2 / val1;
+            } else {
+                result = 0;
+                fprintf(interp->out, RED "Warning: Division by zero!\n" RESET);
+            }
+            strcpy(op_name, "Division");
+            op_symbol = '/';
+            break;
+        case 4: // Power
+            result = pow(val2, val1);
+            strcpy(op_name, "Power");
+            op_symbol = '^';
+            break;
+        case 5: // Square root
+            result = sqrt(val1);
+            strcpy(op_name, "Square root");
+            break;
+        case 6: // Sine
+            result = sin(val1);
+            strcpy(op_name, "Sine");
+            break;
+        case 7: // Cosine
+            result = cos(val1);
+            strcpy(op_name, "Cosine");
+            break;
+        case 8: // Logarithm
+            if (val1 > 0) {
+                result = log(val1);
+            } else {
+                result = 0;
+                fprintf(interp->out, RED "Warning: Logarithm of non-positive number!\n" RESET);
+            }
+            strcpy(op_name, "Logarithm");
+            break;
+        case 9: // Modulo
+            if (val1 != 0) {
+                result = fmod(val2, val1);
+            } else {
+                result = 0;
+                fprintf(interp->out, RED "Warning: Modulo by zero!\n" RESET);
+            }
+            strcpy(op_name, "Modulo");
+            op_symbol = '%';
+            break;
+    }
+
+    if (operation <= 4 || operation == 9) {
+        fprintf(interp->out, GREEN "%s: %.2f %c %.2f = %.2f\n" RESET, op_name, val2, op_symbol, val1, result);
+    } else {
+        fprintf(interp->out, GREEN "%s(%.2f) = %.2f\n" RESET, op_name, val1, result);
+    }
+
+    // Store result as new variable
+    if (interp->var_count < interp->var_capacity) {
+        Variable *var = &interp->vars[interp->var_count];
+        var->type = 6; // Float result
+        name_variable(interp, var, "result_", position, "");
+        var->value.float_val = result;
+        fprintf(interp->out, CYAN "Result stored in variable %s = %.2f\n" RESET, var->name, result);
+        interp->var_count++;
+    }
+}
+
+// Condition of WHILE loops on the most recent variable
+bool loop_condition(NumoInterpreter *interp) {
+    if (interp->var_count == 0) return false;
+    Variable *var = &interp->vars[interp->var_count - 1];
+    switch (var->type) {
+        case 3: return var->value.int_val > 0;
+        case 5: return var->value.bool_val;
+        case 6: return var->value.float_val > 0.0;
+        case 7: return var->value.array_val->length > 0;
+        case 8: return var->value.big_val->sign > 0;
+        case 9: return var->value.dict_val->count > 0;
+        default: return false;
+    }
+}
+
+// Enter a paired loop body, or skip past its END-LOOP when it runs zero
+// times. iterations < 0 means a condition loop, entered while it holds.
+void enter_loop(NumoInterpreter *interp, int position, long iterations, const char *name) {
+    int end = interp->jump_table[position];
+    bool enter = (iterations < 0) ? loop_condition(interp) : iterations > 0;
+
+    if (!enter) {
+        fprintf(interp->out, CYAN "%s loop skipped to position %s\n" RESET, name, pos_text(interp, end + 1));
+        interp->position = end;
+        return;
+    }
+    if (interp->loop_sp >= MAX_STACK_SIZE) {
+        fprintf(interp->out, RED "Error: Loops nested too deeply, skipping body\n" RESET);
+        interp->position = end;
+        return;
+    }
+
+    LoopFrame *loop = &interp->loops[interp->loop_sp++];
+    loop->start = position;
+    loop->end = end;
+    loop->total = iterations;
+    loop->remaining = iterations;
+    loop->iteration = 1;
+    loop->name = name;
+    if (iterations < 0) {
+        fprintf(interp->out, BLUE "  %s iteration 1\n" RESET, name);
+    } else {
+        fprintf(interp->out, BLUE "  %s iteration 1/%ld\n" RESET, name, iterations);
+    }
+}
+
+// END-LOOP: go back to the body start or leave the loop. Inner loops left
+// by a jump are dropped; returns false if no active loop ends here.
+bool end_loop(NumoInterpreter *interp, int position) {
+    int i = interp->loop_sp - 1;
+    while (i >= 0 && interp->loops[i].end != position) i--;
+    if (i < 0) return false;
+
+    interp->loop_sp = i + 1;
+    LoopFrame *loop = &interp->loops[i];
+    bool again = (loop->total < 0) ? loop_condition(interp) : --loop->remaining > 0;
+
+    if (again) {
+        loop->iteration++;
+        if (loop->total < 0) {
+            fprintf(interp->out, BLUE "  %s iteration %ld\n" RESET, loop->name, loop->iteration);
+        } else {
+            fprintf(interp->out, BLUE "  %s iteration %ld/%ld\n" RESET, loop->name, loop->iteration, loop->total);
+        }
+        interp->position = loop->start;
+    } else {
+        fprintf(interp->out, GREEN "%s loop finished after %ld iterations\n" RESET, loop->name, loop->iteration);
+        interp->loop_sp--;
+    }
+    return true;
+}
+
+// Substring search: memchr for one byte, a 16-byte first/last byte filter
+// for short needles, two-way (Crochemore-Perrin, linear time, constant
+// space) from TWO_WAY_MIN_NEEDLE bytes
+#define TWO_WAY_MIN_NEEDLE 32
+#define NOT_FOUND SIZE_MAX
+
+size_t two_way_search(const unsigned char *hay, size_t hay_len, const unsigned char *needle, size_t needle_len) {
+    size_t byteset[256 / (8 * sizeof(size_t))] = { 0 };
+    size_t shift[256];
+    for (size_t i = 0; i < needle_len; i++) {
+        byteset[needle[i] / (8 * sizeof(size_t))] |= (size_t)1 << (needle[i] % (8 * sizeof(size_t)));
+        shift[needle[i]] = i + 1;
+    }
+
+    // Critical factorization: maximal suffix under both byte orders
+    size_t split = 0, period = 1, first_period = 1;
+    for (int order = 0; order < 2; order++) {
+        size_t ip = (size_t)-1, jp = 0, k = 1, p = 1;
+        while (jp + k < needle_len) {
+            unsigned char a = needle[ip + k], b = needle[jp + k];
+            if (a == b) {
+                if (k == p) {
+                    jp += p;
+                    k = 1;
+                } else {
+                    k++;
+                }
+            } else if (order == 0 ? a > b : a < b) {
+                jp += k;
+                k = 1;
+                p = jp - ip;
+            } else {
+                ip = jp++;
+                k = p = 1;
+            }
+        }
+        if (order == 0) {
+            split = ip;
+            first_period = p;
+        } else if (ip + 1 > split + 1) {
+            split = ip;
+            period = p;
+        } else {
+            period = first_period;
+        }
+    }
+
+    // Periodic needles remember how much of the last match still holds
+    size_t memory_reset;
+    if (memcmp(needle, needle + period, split + 1) != 0) {
+        memory_reset = 0;
+        period = (split > needle_len - split - 1 ? split : needle_len - split - 1) + 1;
+    } else {
+        memory_reset = needle_len - period;
+    }
+
+    size_t memory = 0;
+    const unsigned char *h = hay;
+    const unsigned char *end = hay + hay_len;
+    while ((size_t)(end - h) >= needle_len) {
+        unsigned char last = h[needle_len - 1];
+        if (byteset[last / (8 * sizeof(size_t))] & ((size_t)1 << (last % (8 * sizeof(size_t))))) {
+            size_t skip = needle_len - shift[last];
+            if (skip) {
+                h += skip < memory ? memory : skip;
+                memory = 0;
+                continue;
+            }
+        } else {
+            h += needle_len;
+            memory = 0;
+            continue;
+        }
+
+        size_t k = split + 1 > memory ? split + 1 : memory;
+        while (k < needle_len && needle[k] == h[k]) k++;
+        if (k < needle_len) {
+            h += k - split;
+            memory = 0;
+            continue;
+        }
+        for (k = split + 1; k > memory && needle[k - 1] == h[k - 1]; k--);
+        if (k <= memory) return h - hay;
+        h += period;
+        memory = memory_reset;
+    }
+    return NOT_FOUND;
+}
+
+// First byte located with memchr (or 16 candidates at once, checked on
+// the first and last needle byte), then the middle compared
+size_t filter_search(const char *hay, size_t hay_len, const char *needle, size_t needle_len) {
+    size_t end = hay_len - needle_len + 1;
+    size_t i = 0;
+#if defined(__SSE2__)
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+    for (; i + 16 <= end; i += 16) {
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(hay + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i *)(hay + i + needle_len - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                                        _mm_cmpeq_epi8(last, block_last)));
+        while (mask) {
+            size_t candidate = i + __builtin_ctz(mask);
+            if (memcmp(hay + candidate + 1, needle + 1, needle_len - 2) == 0) return candidate;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    while (i < end) {
+        const char *match = memchr(hay + i, needle[0], end - i);
+        if (!match) break;
+        i = match - hay;
+        if (memcmp(hay + i + 1, needle + 1, needle_len - 1) == 0) return i;
+        i++;
+    }
+    return NOT_FOUND;
+}
+
+// Index of the first needle at or after `from`, or NOT_FOUND
+size_t find_substring(const char *hay, size_t hay_len, const char *needle, size_t needle_len, size_t from) {
+    if (from > hay_len || needle_len > hay_len - from) return NOT_FOUND;
+    if (needle_len == 0) return from;
+    size_t found;
+    if (needle_len == 1) {
+        const char *match = memchr(hay + from, needle[0], hay_len - from);
+        return match ? (size_t)(match - hay) : NOT_FOUND;
+    } else if (needle_len < TWO_WAY_MIN_NEEDLE) {
+        found = filter_search(hay + from, hay_len - from, needle, needle_len);
+    } else {
+        found = two_way_search((const unsigned char *)hay + from, hay_len - from,
+                               (const unsigned char *)needle, needle_len);
+    }
+    return found == NOT_FOUND ? NOT_FOUND : found + from;
+}
+
+// ASCII case conversion in place, 16 bytes per step; other bytes unchanged
+void convert_case(char *text, size_t length, bool upper) {
+    typedef unsigned char v16u __attribute__((vector_size(16)));
+    unsigned char low = upper ? 'a' : 'A';
+    unsigned char high = upper ? 'z' : 'Z';
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        v16u block;
+        memcpy(&block, text + i, 16);
+        v16u letters = (v16u)((block >= low) & (block <= high));
+        block ^= letters & 0x20;
+        memcpy(text + i, &block, 16);
+    }
+    for (; i < length; i++) {
+        unsigned char c = text[i];
+        if (c >= low && c <= high) text[i] = c ^ 0x20;
+    }
+}
+
+// Up to `count` most recent string variables, most recent first
+int recent_strings(NumoInterpreter *interp, Variable **found, int count) {
+    int total = 0;
+    for (int i = interp->var_count - 1; i >= 0 && total < count; i--) {
+        if (interp->vars[i].type == 4) found[total++] = &interp->vars[i];
+    }
+    return total;
+}
+
+// Contiguous, NUL-terminated copy of a string; NULL when out of memory
+char *string_dup(const NumStr *str, size_t *length) {
+    *length = string_length(str);
+    char *text = malloc(*length + 1);
+    if (!text) return NULL;
+    string_flatten(str, text);
+    text[*length] = '\0';
+    return text;
+}
+
+// Store a string result as result_N and show its start
+void store_string_result(NumoInterpreter *interp, const NumStr *str, int position) {
+    if (interp->var_count >= interp->var_capacity) return;
+    Variable *var = &interp->vars[interp->var_count];
+    var->type = 4;
+    name_variable(interp, var, "result_", position, "");
+    var->value.str_val = *str;
+    fprintf(interp->out, CYAN "Result stored in variable %s = \"" RESET, var->name);
+    print_string(interp->out, str, 64);
+    fprintf(interp->out, "\"\n");
+    interp->var_count++;
+}
+
+// Concatenate the two most recent string variables, older one first, into
+// a new string; false when there are fewer than two
+bool concat_strings(NumoInterpreter *interp, int position) {
+    Variable *parts[2];
+    if (recent_strings(interp, parts, 2) < 2) return false;
+
+    if (string_length(&parts[1]->value.str_val) + string_length(&parts[0]->value.str_val) > STRING_MAX_LENGTH) {
+        fprintf(interp->out, RED "Warning: Concatenation over %d chars skipped\n" RESET, STRING_MAX_LENGTH);
+        return true;
+    }
+    NumStr result;
+    if (!string_concat(interp, &result, &parts[1]->value.str_val, &parts[0]->value.str_val)) {
+        fprintf(interp->out, RED "Error: Cannot allocate string\n" RESET);
+        return true;
+    }
+    fprintf(interp->out, GREEN "Concatenation: %s + %s (%zu chars)\n" RESET, parts[1]->name, parts[0]->name,
+            string_length(&result));
+    store_string_result(interp, &result, position);
+    return true;
+}
+
+// Every occurrence of needle in text replaced; NULL when out of memory
+char *replace_all(const char *text, size_t length, const char *needle, size_t needle_len,
+                  const char *replacement, size_t replacement_len, size_t *result_len, size_t *count) {
+    *count = 0;
+    size_t capacity = length + 1;
+    char *result = malloc(capacity);
+    size_t used = 0, from = 0;
+    while (result && needle_len > 0) {
+        size_t match = find_substring(text, length, needle, needle_len, from);
+        if (match == NOT_FOUND) break;
+        size_t needed = used + (match - from) + replacement_len + (length - match - needle_len) + 1;
+        if (needed > capacity) {
+            capacity = needed > 2 * capacity ? needed : 2 * capacity;
+            char *grown = realloc(result, capacity);
+            if (!grown) {
+                free(result);
+                return NULL;
+            }
+            result = grown;
+        }
+        memcpy(result + used, text + from, match - from);
+        used += match - from;
+        memcpy(result + used, replacement, replacement_len);
+        used += replacement_len;
+        from = match + needle_len;
+        (*count)++;
+    }
+    if (!result) return NULL;
+    memcpy(result + used, text + from, length - from);
+    used += length - from;
+    *result_len = used;
+    return result;
+}
+
+// String ops when the most recent variable is a string (--strings):
+// 76 upper case, 86 lower case, 96 index of the newest string in the one
+// before it (-1 if absent), 06 replace the second newest string by the
+// newest in the third newest. False when the op has no string operands.
+bool string_operation(NumoInterpreter *interp, int prev_digit, int position) {
+    if (!interp->strings_enabled || interp->var_count == 0 || interp->vars[interp->var_count - 1].type != 4) {
+        return false;
+    }
+    Variable *parts[3];
+    int found = recent_strings(interp, parts, 3);
+    if ((prev_digit == 9 && found < 2) || (prev_digit == 0 && found < 3)) return false;
+
+    size_t length, needle_len, replacement_len;
+    char *text = string_dup(&parts[prev_digit == 0 ? 2 : prev_digit == 9 ? 1 : 0]->value.str_val, &length);
+    char *needle = (prev_digit == 9 || prev_digit == 0) ? string_dup(&parts[prev_digit == 0 ? 1 : 0]->value.str_val, &needle_len) : NULL;
+    char *replacement = (prev_digit == 0) ? string_dup(&parts[0]->value.str_val, &replacement_len) : NULL;
+    if (!text || ((prev_digit == 9 || prev_digit == 0) && !needle) || (prev_digit == 0 && !replacement)) {
+        fprintf(interp->out, RED "Error: Cannot allocate string\n" RESET);
+        free(text);
+        free(needle);
+        free(replacement);
+        return true;
+    }
+
+    NumStr result;
+    switch (prev_digit) {
+        case 7:
+        case 8:
+            convert_case(text, length, prev_digit == 7);
+            fprintf(interp->out, GREEN "%s case of %s (%zu chars)\n" RESET, prev_digit == 7 ? "Upper" : "Lower",
+                    parts[0]->name, length);
+            if (string_set(interp, &result, text, length)) store_string_result(interp, &result, position);
+            break;
+
+        case 9: {
+            size_t match = find_substring(text, length, needle, needle_len, 0);
+            long long index = (match == NOT_FOUND) ? -1 : (long long)match;
+            fprintf(interp->out, GREEN "Search %s in %s: %s\n" RESET, parts[0]->name, parts[1]->name,
+                    match == NOT_FOUND ? "not found" : "found");
+            if (interp->var_count < interp->var_capacity) {
+                Variable *var = &interp->vars[interp->var_count];
+                var->type = 3;
+                name_variable(interp, var, "result_", position, "");
+                var->value.int_val = index;
+                fprintf(interp->out, CYAN "Result stored in variable %s = %lld\n" RESET, var->name, index);
+                interp->var_count++;
+            }
+            break;
+        }
+
+        default: {
+            size_t result_len, count;
+            char *replaced = replace_all(text, length, needle, needle_len, replacement, replacement_len,
+                                         &result_len, &count);
+            if (!replaced || result_len > STRING_MAX_LENGTH) {
+                fprintf(interp->out, RED "Warning: Replacement in %s skipped\n" RESET, parts[2]->name);
+            } else {
+                fprintf(interp->out, GREEN "Replace %s by %s in %s: %zu occurrences\n" RESET, parts[1]->name,
+                        parts[0]->name, parts[2]->name, count);
+                if (string_set(interp, &result, replaced, result_len)) store_string_result(interp, &result, position);
+            }
+            free(replaced);
+            break;
+        }
+    }
+    free(text);
+    free(needle);
+    free(replacement);
+    return true;
+}
+
+// Split (92, --strings) the second newest string on the newest one, each
+// piece a new string variable split_N_i while the table has room
+bool split_strings(NumoInterpreter *interp, int position) {
+    Variable *parts[2];
+    if (recent_strings(interp, parts, 2) < 2) return false;
+
+    size_t length, separator_len;
+    char *text = string_dup(&parts[1]->value.str_val, &length);
+    char *separator = string_dup(&parts[0]->value.str_val, &separator_len);
+    if (!text || !separator) {
+        fprintf(interp->out, RED "Error: Cannot allocate string\n" RESET);
+        free(text);
+        free(separator);
+        return true;
+    }
+
+    size_t pieces = 0, stored = 0, from = 0;
+    for (;;) {
+        size_t match = separator_len ? find_substring(text, length, separator, separator_len, from) : NOT_FOUND;
+        size_t end = (match == NOT_FOUND) ? length : match;
+        if (interp->var_count < interp->var_capacity) {
+            Variable *var = &interp->vars[interp->var_count];
+            var->type = 4;
+            char suffix[24];
+            snprintf(suffix, sizeof(suffix), "_%zu", pieces);
+            name_variable(interp, var, "split_", position, suffix);
+            if (string_set(interp, &var->value.str_val, text + from, end - from)) {
+                interp->var_count++;
+                stored++;
+            }
+        }
+        pieces++;
+        if (match == NOT_FOUND) break;
+        from = match + separator_len;
+    }
+    fprintf(interp->out, GREEN "Split %s on %s: %zu pieces, %zu stored as split_%s_*\n" RESET, parts[1]->name,
+            parts[0]->name, pieces, stored, pos_text(interp, position));
+    free(text);
+    free(separator);
+    return true;
+}
+
+// splitmix64 finalizer: spreads int keys and FNV string hashes over all
+// 64 bits, the low 7 going to the control byte
+uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Bit i set when byte i of the 16-byte group equals `byte`
+unsigned group_match(const uint8_t *group, uint8_t byte) {
+#if defined(__SSE2__)
+    __m128i bytes = _mm_loadu_si128((const __m128i *)group);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)byte)));
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < DICT_GROUP; i++) mask |= (unsigned)(group[i] == byte) << i;
+    return mask;
+#endif
+}
+
+// Bit i set when slot i of the group is empty or deleted (high bit)
+unsigned group_free(const uint8_t *group) {
+#if defined(__SSE2__)
+    return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+#else
+    unsigned mask = 0;
+    for (int i = 0; i < DICT_GROUP; i++) mask |= (unsigned)(group[i] >> 7) << i;
+    return mask;
+#endif
+}
+
+NumDict *new_dict(NumoInterpreter *interp) {
+    NumDict *dict = calloc(1, sizeof(NumDict));
+    uint8_t *control = malloc(DICT_GROUP);
+    DictSlot *slots = malloc(DICT_GROUP * sizeof(DictSlot));
+    if (!dict || !control || !slots) {
+        free(dict);
+        free(control);
+        free(slots);
+        fprintf(interp->out, RED "Error: Cannot allocate dictionary\n" RESET);
+        return NULL;
+    }
+    memset(control, CTRL_EMPTY, DICT_GROUP);
+    dict->capacity = DICT_GROUP;
+    dict->control = control;
+    dict->slots = slots;
+    dict->next = interp->dicts;
+    interp->dicts = dict;
+    return dict;
+}
+
+// Groups are probed triangularly (offsets 0, 1, 3, 6...), which visits
+// every group of a power-of-two table; a group with an empty slot ends
+// the probe
+bool dict_find(const NumDict *dict, uint64_t hash, int key_type, DictKey key, size_t *slot) {
+    size_t groups = dict->capacity / DICT_GROUP;
+    size_t group = (hash >> 7) & (groups - 1);
+    for (size_t step = 0; step < groups; step++) {
+        const uint8_t *control = dict->control + group * DICT_GROUP;
+        for (unsigned mask = group_match(control, hash & 0x7f); mask; mask &= mask - 1) {
+            size_t index = group * DICT_GROUP + __builtin_ctz(mask);
+            const DictSlot *candidate = &dict->slots[index];
+            if (candidate->hash == hash && candidate->key_type == key_type &&
+                (key_type == 3 ? candidate->key.int_key == key.int_key : candidate->key.str_key == key.str_key)) {
+                *slot = index;
+                return true;
+            }
+        }
+        if (group_match(control, CTRL_EMPTY)) return false;
+        group = (group + step + 1) & (groups - 1);
+    }
+    return false;
+}
+
+// First empty or deleted slot on the probe sequence of hash
+size_t dict_free_slot(const NumDict *dict, uint64_t hash) {
+    size_t groups = dict->capacity / DICT_GROUP;
+    size_t group = (hash >> 7) & (groups - 1);
+    for (size_t step = 0;; step++) {
+        unsigned mask = group_free(dict->control + group * DICT_GROUP);
+        if (mask) return group * DICT_GROUP + __builtin_ctz(mask);
+        group = (group + step + 1) & (groups - 1);
+    }
+}
+
+// Rehash into `capacity` slots, dropping tombstones
+bool dict_resize(NumDict *dict, size_t capacity) {
+    uint8_t *control = malloc(capacity);
+    DictSlot *slots = malloc(capacity * sizeof(DictSlot));
+    if (!control || !slots) {
+        free(control);
+        free(slots);
+        return false;
+    }
+    memset(control, CTRL_EMPTY, capacity);
+
+    NumDict resized = *dict;
+    resized.capacity = capacity;
+    resized.control = control;
+    resized.slots = slots;
+    for (size_t i = 0; i < dict->capacity; i++) {
+        if (dict->control[i] & 0x80) continue;
+        size_t index = dict_free_slot(&resized, dict->slots[i].hash);
+        control[index] = dict->control[i];
+        slots[index] = dict->slots[i];
+    }
+    free(dict->control);
+    free(dict->slots);
+    dict->capacity = capacity;
+    dict->control = control;
+    dict->slots = slots;
+    dict->tombstones = 0;
+    return true;
+}
+
+// Slot for key, inserted empty (value_type 0) if absent; NULL when full
+// or out of memory. Tables stay at most 7/8 full, tombstones included.
+DictSlot *dict_insert(NumDict *dict, uint64_t hash, int key_type, DictKey key) {
+    size_t index;
+    if (dict_find(dict, hash, key_type, key, &index)) return &dict->slots[index];
+    if (dict->count >= DICT_MAX_ENTRIES) return NULL;
+
+    if ((dict->count + dict->tombstones + 1) * 8 > dict->capacity * 7) {
+        size_t capacity = ((dict->count + 1) * 16 > dict->capacity * 7) ? dict->capacity * 2 : dict->capacity;
+        if (!dict_resize(dict, capacity)) return NULL;
+    }
+    index = dict_free_slot(dict, hash);
+    if (dict->control[index] == CTRL_DELETED) dict->tombstones--;
+    dict->control[index] = hash & 0x7f;
+    DictSlot *slot = &dict->slots[index];
+    slot->hash = hash;
+    slot->key = key;
+    slot->key_type = key_type;
+    slot->value_type = 0;
+    dict->count++;
+    return slot;
+}
+
+// A slot whose group still has an empty slot can become empty again: no
+// probe ever passed through that group
+bool dict_delete(NumDict *dict, uint64_t hash, int key_type, DictKey key) {
+    size_t index;
+    if (!dict_find(dict, hash, key_type, key, &index)) return false;
+    const uint8_t *group = dict->control + (index & ~(size_t)(DICT_GROUP - 1));
+    if (group_match(group, CTRL_EMPTY)) {
+        dict->control[index] = CTRL_EMPTY;
+    } else {
+        dict->control[index] = CTRL_DELETED;
+        dict->tombstones++;
+    }
+    dict->count--;
+    return true;
+}
+
+// Interned leaf for a string, so equal text gives the same key pointer
+Rope *string_key(NumoInterpreter *interp, const NumStr *str) {
+    if (!str->rope) return intern_leaf(interp, str->chars, strlen(str->chars));
+    if (str->rope->height == 0) return str->rope;
+    size_t length;
+    char *text = string_dup(str, &length);
+    if (!text) return NULL;
+    Rope *leaf = intern_leaf(interp, text, length);
+    free(text);
+    return leaf;
+}
+
+// Key of an int or string variable; false for other types
+bool variable_key(NumoInterpreter *interp, const Variable *var, DictKey *key, uint64_t *hash) {
+    if (var->type == 3) {
+        key->int_key = var->value.int_val;
+        *hash = mix64((uint64_t)var->value.int_val);
+        return true;
+    }
+    if (var->type == 4) {
+        key->str_key = string_key(interp, &var->value.str_val);
+        if (!key->str_key) return false;
+        *hash = mix64(key->str_key->hash);
+        return true;
+    }
+    return false;
+}
+
+void print_dict_key(FILE *out, const DictSlot *slot) {
+    if (slot->key_type == 3) {
+        fprintf(out, "%lld", slot->key.int_key);
+    } else {
+        NumStr str = { slot->key.str_key, "" };
+        fprintf(out, "\"");
+        print_string(out, &str, 64);
+        fprintf(out, "\"");
+    }
+}
+
+void print_dict_value(FILE *out, const DictSlot *slot) {
+    NumStr str = { slot->value.str_val, "" };
+    switch (slot->value_type) {
+        case 3: fprintf(out, "%lld", slot->value.int_val); break;
+        case 4: fprintf(out, "\""); print_string(out, &str, 64); fprintf(out, "\""); break;
+        case 5: fprintf(out, "%s", slot->value.bool_val ? "true" : "false"); break;
+        case 6: fprintf(out, "%.2f", slot->value.float_val); break;
+        case 7: print_array(out, slot->value.array_val); break;
+        case 8: print_bignum(out, slot->value.big_val); break;
+    }
+}
+
+// Entries in slot order, the first `limit` of them (0 = all)
+void print_dict(FILE *out, const NumDict *dict, size_t limit) {
+    size_t shown = 0;
+    fprintf(out, "{");
+    for (size_t i = 0; i < dict->capacity && (!limit || shown < limit); i++) {
+        if (dict->control[i] & 0x80) continue;
+        fprintf(out, "%s", shown ? ", " : "");
+        print_dict_key(out, &dict->slots[i]);
+        fprintf(out, ": ");
+        print_dict_value(out, &dict->slots[i]);
+        shown++;
+    }
+    fprintf(out, "%s} (%zu entries)", dict->count > shown ? ", ..." : "", dict->count);
+}
+
+// Key hashes and values of every entry, in slot order
+uint64_t hash_dict(uint64_t hash, const NumDict *dict) {
+    hash = hash_bytes(hash, &dict->count, sizeof(dict->count));
+    for (size_t i = 0; i < dict->capacity; i++) {
+        if (dict->control[i] & 0x80) continue;
+        const DictSlot *slot = &dict->slots[i];
+        hash = hash_bytes(hash, &slot->hash, sizeof(slot->hash));
+        hash = hash_bytes(hash, &slot->value_type, sizeof(slot->value_type));
+        switch (slot->value_type) {
+            case 4: hash = rope_hash(hash, slot->value.str_val); break;
+            case 7:
+                hash = hash_bytes(hash, slot->value.array_val->data, slot->value.array_val->length * sizeof(double));
+                break;
+            case 8:
+                hash = hash_bytes(hash, &slot->value.big_val->sign, sizeof(int));
+                hash = hash_bytes(hash, slot->value.big_val->limbs, slot->value.big_val->len * sizeof(uint32_t));
+                break;
+            default: hash = hash_bytes(hash, &slot->value, sizeof(slot->value)); break;
+        }
+    }
+    return hash;
+}
+
+// Dictionary ops (--dicts), digit 9 after: 3 new dict, 0 insert (key =
+// second newest non-dict variable, value = newest), 1 lookup and 2 delete
+// (key = newest non-dict variable). They act on the newest dict.
+void handle_dict_op(NumoInterpreter *interp, int kind, int position) {
+    if (kind == 3) {
+        if (interp->var_count >= interp->var_capacity) return;
+        NumDict *dict = new_dict(interp);
+        if (!dict) return;
+        Variable *var = &interp->vars[interp->var_count];
+        var->type = 9;
+        name_variable(interp, var, "dict_", position, "");
+        var->value.dict_val = dict;
+        fprintf(interp->out, CYAN "Created DICT variable %s = {} (0 entries)\n" RESET, var->name);
+        interp->var_count++;
+        return;
+    }
+
+    Variable *dict_var = NULL;
+    Variable *operands[2] = { NULL, NULL };
+    int found = 0;
+    for (int i = interp->var_count - 1; i >= 0 && (!dict_var || found < 2); i--) {
+        if (interp->vars[i].type == 9) {
+            if (!dict_var) dict_var = &interp->vars[i];
+        } else if (found < 2) {
+            operands[found++] = &interp->vars[i];
+        }
+    }
+    int needed = (kind == 0) ? 2 : 1;
+    if (!dict_var || found < needed) {
+        fprintf(interp->out, RED "Error: Need a dictionary and %d variable%s\n" RESET, needed, needed > 1 ? "s" : "");
+        return;
+    }
+    NumDict *dict = dict_var->value.dict_val;
+    Variable *key_var = operands[needed - 1];
+    DictKey key;
+    uint64_t hash;
+    if (!variable_key(interp, key_var, &key, &hash)) {
+        fprintf(interp->out, RED "Error: Dictionary keys must be int or string\n" RESET);
+        return;
+    }
+
+    size_t index;
+    switch (kind) {
+        case 0: { // Insert or replace
+            Variable *value_var = operands[0];
+            DictSlot *slot = dict_insert(dict, hash, key_var->type, key);
+            if (!slot) {
+                fprintf(interp->out, RED "Error: Cannot grow dictionary %s\n" RESET, dict_var->name);
+                return;
+            }
+            slot->value_type = value_var->type;
+            switch (value_var->type) {
+                case 4: {
+                    const NumStr *str = &value_var->value.str_val;
+                    slot->value.str_val = str->rope ? str->rope : intern_leaf(interp, str->chars, strlen(str->chars));
+                    if (!slot->value.str_val) slot->value_type = 3, slot->value.int_val = 0;
+                    break;
+                }
+                case 3: slot->value.int_val = value_var->value.int_val; break;
+                case 5: slot->value.bool_val = value_var->value.bool_val; break;
+                case 6: slot->value.float_val = value_var->value.float_val; break;
+                case 7: slot->value.array_val = value_var->value.array_val; break;
+                case 8: slot->value.big_val = value_var->value.big_val; break;
+            }
+            fprintf(interp->out, GREEN "Inserted ");
+            print_dict_key(interp->out, slot);
+            fprintf(interp->out, " -> ");
+            print_dict_value(interp->out, slot);
+            fprintf(interp->out, " into %s (%zu entries)\n" RESET, dict_var->name, dict->count);
+            break;
+        }
+
+        case 1: { // Lookup into a new variable
+            if (!dict_find(dict, hash, key_var->type, key, &index)) {
+                fprintf(interp->out, YELLOW "Lookup in %s: key not found\n" RESET, dict_var->name);
+                break;
+            }
+            const DictSlot *slot = &dict->slots[index];
+            fprintf(interp->out, GREEN "Lookup in %s: found\n" RESET, dict_var->name);
+            if (interp->var_count >= interp->var_capacity) break;
+            Variable *var = &interp->vars[interp->var_count];
+            var->type = slot->value_type;
+            name_variable(interp, var, "lookup_", position, "");
+            switch (slot->value_type) {
+                case 4: {
+                    const Rope *text = slot->value.str_val;
+                    if (text->length < STR_INLINE) {
+                        memcpy(var->value.str_val.chars, text->text, text->length + 1);
+                        var->value.str_val.rope = NULL;
+                    } else {
+                        var->value.str_val.chars[0] = '\0';
+                        var->value.str_val.rope = slot->value.str_val;
+                    }
+                    break;
+                }
+                case 3: var->value.int_val = slot->value.int_val; break;
+                case 5: var->value.bool_val = slot->value.bool_val; break;
+                case 6: var->value.float_val = slot->value.float_val; break;
+                case 7: var->value.array_val = slot->value.array_val; break;
+                case 8: var->value.big_val = slot->value.big_val; break;
+            }
+            fprintf(interp->out, CYAN "Result stored in variable %s = " RESET, var->name);
+            print_dict_value(interp->out, slot);
+            fprintf(interp->out, "\n");
+            interp->var_count++;
+            break;
+        }
+
+        default: // Delete
+            if (dict_delete(dict, hash, key_var->type, key)) {
+                fprintf(interp->out, GREEN "Deleted key from %s (%zu entries)\n" RESET, dict_var->name, dict->count);
+            } else {
+                fprintf(interp->out, YELLOW "Delete from %s: key not found\n" RESET, dict_var->name);
+            }
+            break;
+    }
+}
+
+// Whether the newest IF frame was pushed by the IF at if_pos. A full stack
+// drops pushes, and unpaired IFs leave frames behind, so a paired ELSE or
+// END-IF only uses the frame when it is its own.
+bool top_frame_is(NumoInterpreter *interp, int if_pos) {
+    return interp->stack_pointer > 0 && interp->stack[interp->stack_pointer - 1].position == if_pos;
+}
+
+// Handle conditionals (digit 6), kind given by the preceding digit
+void handle_conditionals(NumoInterpreter *interp, int prev_digit, int position) {
+    fprintf(interp->out, BLUE "Conditional operation (previous digit: %d) at position %s\n" RESET, prev_digit,
+            pos_text(interp, position));
+    
+    switch (prev_digit) {
+        case 1: // IF condition
+            if (interp->var_count > 0 || interp->jump_table[position] != -1) {
+                bool condition = false;
+                
+                if (interp->var_count > 0) {
+                    Variable *var = &interp->vars[interp->var_count - 1];
+                    switch (var->type) {
+                        case 3: condition = (var->value.int_val != 0); break;
+                        case 5: condition = var->value.bool_val; break;
+                        case 6: condition = (var->value.float_val != 0.0); break;
+                        case 8: condition = (var->value.big_val->sign != 0); break;
+                        default: condition = false; break;
+                    }
+                }
+                
+                if (interp->stack_pointer < MAX_STACK_SIZE) {
+                    interp->stack[interp->stack_pointer].position = position;
+                    interp->stack[interp->stack_pointer].condition_result = condition ? 1 : 0;
+                    interp->stack_pointer++;
+                }
+                
+                fprintf(interp->out, YELLOW "IF condition evaluated to: %s\n" RESET, condition ? "TRUE" : "FALSE");
+
+                // False: continue after the ELSE, or at the END-IF that pops the frame
+                int target = interp->jump_table[position];
+                if (!condition && target != -1) {
+                    int next = (interp->program[target].arg == 2) ? target + 1 : target;
+                    fprintf(interp->out, CYAN "Skipping IF branch to position %s\n" RESET, pos_text(interp, next));
+                    interp->position = next - 1;
+                }
+            }
+            break;
+            
+        case 2: // ELSE
+            if (interp->stack_pointer > 0 && (interp->jump_table[position] == -1 ||
+                                              top_frame_is(interp, interp->jump_table[interp->jump_table[position]]))) {
+                int condition = interp->stack[interp->stack_pointer - 1].condition_result;
+                fprintf(interp->out, MAGENTA "ELSE branch (condition was %s)\n" RESET, condition ? "TRUE" : "FALSE");
+            }
+            // Reached at the end of the IF branch: go to the END-IF
+            if (interp->jump_table[position] != -1) {
+                fprintf(interp->out, CYAN "Skipping ELSE branch to position %s\n" RESET,
+                        pos_text(interp, interp->jump_table[position]));
+                interp->position = interp->jump_table[position] - 1;
+            }
+            break;
+
+        case 6: // END-IF
+            if (interp->jump_table[position] != -1) {
+                if (top_frame_is(interp, interp->jump_table[position])) {
+                    interp->stack_pointer--;
+                }
+                fprintf(interp->out, MAGENTA "END-IF (IF at position %s)\n" RESET,
+                        pos_text(interp, interp->jump_table[position]));
+            } else {
+                fprintf(interp->out, GREEN "Basic conditional operation\n" RESET);
+            }
+            break;
+            
+        case 3: // WHILE loop
+            if (interp->jump_table[position] != -1) {
+                fprintf(interp->out, GREEN "WHILE loop on the last variable\n" RESET);
+                enter_loop(interp, position, -1, "WHILE");
+            } else if (interp->var_count > 0) {
+                Variable *var = &interp->vars[interp->var_count - 1];
+                bool condition = (var->type == 3) ? (var->value.int_val > 0) : true;
+                
+                if (condition && interp->loop_depth < 10) {
+                    interp->loop_depth++;
+                    fprintf(interp->out, GREEN "WHILE loop started (depth: %d)\n" RESET, interp->loop_depth);
+                } else {
+                    fprintf(interp->out, RED "WHILE loop condition false or max depth reached\n" RESET);
+                }
+            }
+            break;
+            
+        case 4: // FOR loop
+            if (interp->var_count > 0) {
+                Variable *var = &interp->vars[interp->var_count - 1];
+                long long iterations = (var->type == 3) ? var->value.int_val : 3;
+                
+                fprintf(interp->out, CYAN "FOR loop with %lld iterations\n" RESET, iterations);
+                if (interp->jump_table[position] != -1) {
+                    enter_loop(interp, position, iterations > 0 ? iterations : 0, "FOR");
+                    break;
+                }
+                
+                for (int i = 0; i < iterations && i < 10; i++) {
+                    fprintf(interp->out, YELLOW "FOR iteration %d/%lld\n" RESET, i + 1, iterations);
+                }
+            } else if (interp->jump_table[position] != -1) {
+                enter_loop(interp, position, 0, "FOR");
+            }
+            break;
+            
+        case 5: // SWITCH-CASE
+            if (interp->var_count > 0) {
+                Variable *var = &interp->vars[interp->var_count - 1];
+                long long case_value = (var->type == 3) ? var->value.int_val : 0;
+                
+                fprintf(interp->out, BLUE "SWITCH-CASE with value: %lld\n" RESET, case_value);
+                
+                switch (case_value % 5) {
+                    case 0: fprintf(interp->out, GREEN "CASE 0: Default case\n" RESET); break;
+                    case 1: fprintf(interp->out, YELLOW "CASE 1: First case\n" RESET); break;
+                    case 2: fprintf(interp->out, MAGENTA "CASE 2: Second case\n" RESET); break;
+                    case 3: fprintf(interp->out, CYAN "CASE 3: Third case\n" RESET); break;
+                    case 4: fprintf(interp->out, RED "CASE 4: Fourth case\n" RESET); break;
+                }
+            }
+            break;
+
+        case 7: // Array reductions (76 sum, 86 min, 96 max, 06 mean) or
+        case 8: // string ops (76 upper, 86 lower, 96 search, 06 replace)
+        case 9:
+        case 0:
+            if (!reduce_last_array(interp, prev_digit, position) && !string_operation(interp, prev_digit, position)) {
+                fprintf(interp->out, GREEN "Basic conditional operation\n" RESET);
+            }
+            break;
+            
+        default:
+            fprintf(interp->out, GREEN "Basic conditional operation\n" RESET);
+            break;
+    }
+}
+
+// Handle loops and iterations (digit 2), kind given by the preceding digit.
+// Loops paired with an END-LOOP (22) re-execute their body; unpaired ones
+// keep the old iteration printout.
+void handle_loops(NumoInterpreter *interp, int prev_digit, int position) {
+    fprintf(interp->out, CYAN "Loop/Iteration operation (previous digit: %d) at position %s\n" RESET, prev_digit,
+            pos_text(interp, position));
+    bool paired = interp->jump_table[position] != -1;
+    
+    switch (prev_digit) {
+        case 1: // Simple FOR loop
+            fprintf(interp->out, YELLOW "Simple FOR loop (3 iterations)\n" RESET);
+            for (int i = 0; i < 3; i++) {
+                fprintf(interp->out, GREEN "  Iteration %d\n" RESET, i + 1);
+            }
+            break;
+            
+        case 3: // WHILE loop based on variable
+            if (interp->var_count > 0) {
+                Variable *var = &interp->vars[interp->var_count - 1];
+                long long count = (var->type == 3) ? var->value.int_val : 2;
+                
+                fprintf(interp->out, MAGENTA "WHILE loop with %lld iterations\n" RESET, count);
+                if (paired) {
+                    enter_loop(interp, position, count > 0 ? count : 0, "WHILE");
+                    break;
+                }
+                int i = 0;
+                while (i < count && i < 5) {
+                    fprintf(interp->out, BLUE "  WHILE iteration %d\n" RESET, i + 1);
+                    i++;
+                }
+            } else if (paired) {
+                enter_loop(interp, position, 0, "WHILE");
+            }
+            break;
+            
+        case 4: // DO-WHILE loop
+            fprintf(interp->out, CYAN "DO-WHILE loop\n" RESET);
+            if (paired) {
+                enter_loop(interp, position, 2, "DO-WHILE");
+                break;
+            }
+            int j = 0;
+            do {
+                fprintf(interp->out, YELLOW "  DO-WHILE iteration %d\n" RESET, j + 1);
+                j++;
+            } while (j < 2);
+            break;
+            
+        case 5: // REPEAT loop
+            if (interp->var_count > 0) {
+                Variable *var = &interp->vars[interp->var_count - 1];
+                long long repeats = (var->type == 3) ? var->value.int_val : 3;
+                
+                fprintf(interp->out, GREEN "REPEAT loop %lld times\n" RESET, repeats);
+                if (paired) {
+                    enter_loop(interp, position, repeats > 0 ? repeats : 0, "REPEAT");
+                    break;
+                }
+                for (int k = 0; k < repeats && k < 4; k++) {
+                    fprintf(interp->out, MAGENTA "  REPEAT %d\n" RESET, k + 1);
+                }
+            } else if (paired) {
+                enter_loop(interp, position, 0, "REPEAT");
+            }
+            break;
+
+        case 2: // END-LOOP
+            if (paired && end_loop(interp, position)) {
+                break;
+            }
+            fprintf(interp->out, RED "End of binary program marker\n" RESET);
+            break;
+
+        case 6: // Array sort (62)
+            if (!sort_last_array(interp)) {
+                fprintf(interp->out, RED "End of binary program marker\n" RESET);
+            }
+            break;
+
+        case 7: // Array dot product (72)
+            if (!array_dot_product(interp, position)) {
+                fprintf(interp->out, RED "End of binary program marker\n" RESET);
+            }
+            break;
+
+        case 8: // String concatenation (82, --strings)
+            if (!interp->strings_enabled || !concat_strings(interp, position)) {
+                fprintf(interp->out, RED "End of binary program marker\n" RESET);
+            }
+            break;
+
+        case 9: // String split (92, --strings)
+            if (!interp->strings_enabled || !split_strings(interp, position)) {
+                fprintf(interp->out, RED "End of binary program marker\n" RESET);
+            }
+            break;
+            
+        default:
+            fprintf(interp->out, RED "End of binary program marker\n" RESET);
+            break;
+    }
+}
+
+// Float variable valued from its position
+void create_float_variable(NumoInterpreter *interp, int position) {
+    if (interp->var_count >= interp->var_capacity) return;
+
+    Variable *var = &interp->vars[interp->var_count];
+    var->type = 6;
+    name_variable(interp, var, "float_var_", position, "");
+    var->value.float_val = (double)(position % 100) / 10.0;
+    fprintf(interp->out, GREEN "Created FLOAT variable %s = %.2f\n" RESET, var->name, var->value.float_val);
+    interp->var_count++;
+}
+
+// Integer variable valued from the next digit
+void create_int_variable(NumoInterpreter *interp, int position, int value) {
+    if (interp->var_count >= interp->var_capacity) return;
+
+    Variable *var = &interp->vars[interp->var_count];
+    var->type = 3;
+    name_variable(interp, var, "int_var_", position, "");
+    var->value.int_val = value;
+    fprintf(interp->out, YELLOW "Created INTEGER variable %s = %lld\n" RESET, var->name, var->value.int_val);
+    interp->var_count++;
+}
+
+// Display the most recent variable
+void display_last_variable(NumoInterpreter *interp) {
+    if (interp->var_count > 0) {
+        Variable *var = &interp->vars[interp->var_count - 1];
+        fprintf(interp->out, BOLD CYAN "=== STRING OUTPUT ===" RESET "\n");
+        
+        switch (var->type) {
+            case 3:
+                fprintf(interp->out, GREEN "Number: %lld\n" RESET, var->value.int_val);
+                break;
+            case 4:
+                fprintf(interp->out, MAGENTA "Text: \"");
+                print_string(interp->out, &var->value.str_val, 0);
+                fprintf(interp->out, "\"\n" RESET);
+                break;
+            case 5:
+                fprintf(interp->out, BLUE "Boolean: %s\n" RESET, var->value.bool_val ? "TRUE" : "FALSE");
+                break;
+            case 6:
+                fprintf(interp->out, YELLOW "Float: %.2f\n" RESET, var->value.float_val);
+                break;
+            case 7:
+                fprintf(interp->out, CYAN "Array: ");
+                print_array(interp->out, var->value.array_val);
+                fprintf(interp->out, "\n" RESET);
+                break;
+            case 8:
+                fprintf(interp->out, GREEN "Number: ");
+                print_bignum(interp->out, var->value.big_val);
+                fprintf(interp->out, "\n" RESET);
+                break;
+            case 9:
+                fprintf(interp->out, CYAN "Dictionary: ");
+                print_dict(interp->out, var->value.dict_val, 16);
+                fprintf(interp->out, "\n" RESET);
+                break;
+            default:
+                fprintf(interp->out, WHITE "Unknown variable type\n" RESET);
+                break;
+        }
+        fprintf(interp->out, BOLD CYAN "===================" RESET "\n");
+    } else {
+        fprintf(interp->out, RED "No variables to display!\n" RESET);
+    }
+}
+
+// String variable valued from its position
+void create_string_variable(NumoInterpreter *interp, int position) {
+    if (interp->var_count < interp->var_capacity) {
+        Variable *var = &interp->vars[interp->var_count];
+        var->type = 4;
+        name_variable(interp, var, "string_var_", position, "");
+        snprintf(var->value.str_val.chars, STR_INLINE, "Hello_%d", position);
+        var->value.str_val.rope = NULL;
+        fprintf(interp->out, MAGENTA "Created STRING variable %s = \"%s\"\n" RESET, var->name, var->value.str_val.chars);
+        interp->var_count++;
+    }
+}
+
+// Execution control: skip the next digit when the last variable is false
+void execution_control(NumoInterpreter *interp) {
+    if (interp->var_count > 0) {
+        Variable *var = &interp->vars[interp->var_count - 1];
+        bool condition = false;
+        
+        switch (var->type) {
+            case 3: condition = (var->value.int_val > 0); break;
+            case 5: condition = var->value.bool_val; break;
+            case 6: condition = (var->value.float_val > 0.0); break;
+            case 8: condition = (var->value.big_val->sign > 0); break;
+            default: condition = true; break;
+        }
+        
+        if (condition) {
+            fprintf(interp->out, GREEN "EXECUTION CONTROL: Condition TRUE - Continue program\n" RESET);
+            // Continue normal execution
+        } else {
+            fprintf(interp->out, RED "EXECUTION CONTROL: Condition FALSE - Skip next operation\n" RESET);
+            // Skip next position
+            if (interp->position + 1 < interp->code_length) {
+                interp->position++;
+            }
+        }
+    }
+}
+
+// Boolean variable valued from its position
+void create_bool_variable(NumoInterpreter *interp, int position) {
+    if (interp->var_count < interp->var_capacity) {
+        Variable *var = &interp->vars[interp->var_count];
+        var->type = 5;
+        name_variable(interp, var, "bool_var_", position, "");
+        var->value.bool_val = (position % 2 == 0);
+        fprintf(interp->out, BLUE "Created BOOLEAN variable %s = %s\n" RESET, var->name, 
+               var->value.bool_val ? "TRUE" : "FALSE");
+        interp->var_count++;
+    }
+}
+
+// Queue host input for programs run with host_input set. The buffer is
+// kept NUL-terminated so the readers can stop at the terminator.
+bool numo_provide_input(NumoInterpreter *interp, const char *data, size_t len) {
+    size_t remaining = interp->input_len - interp->input_pos;
+    char *buffer = realloc(interp->input_data, remaining + len + 1);
+    if (!buffer) return false;
+    memmove(buffer, buffer + interp->input_pos, remaining);
+    memcpy(buffer + remaining, data, len);
+    buffer[remaining + len] = '\0';
+    interp->input_data = buffer;
+    interp->input_len = remaining + len;
+    interp->input_pos = 0;
+    return true;
+}
+
+// No more host input: pending input ops see end of file
+void numo_close_input(NumoInterpreter *interp) {
+    interp->input_closed = true;
+}
+
+// Read a whole stream (--input file, or stdin when it is not a terminal)
+// into the host input buffer, so reads parse memory instead of calling
+// stdio once per digit
+bool numo_load_input(NumoInterpreter *interp, FILE *in) {
+    char chunk[65536];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        if (!numo_provide_input(interp, chunk, got)) return false;
+    }
+    interp->host_input = true;
+    interp->input_tty = false;
+    numo_close_input(interp);
+    return !ferror(in);
+}
+
+// Non-terminal stdin is loaded on the first read
+void input_prepare(NumoInterpreter *interp) {
+    if (!interp->host_input && !interp->input_tty) {
+        numo_load_input(interp, stdin);
+    }
+}
+
+// Pause waits for Enter only on a live terminal
+bool pause_waits(NumoInterpreter *interp) {
+    return interp->input_tty && interp->term_mode == TERM_LIVE;
+}
+
+// Note a terminal effect skipped by --headless-record
+void record_term_event(NumoInterpreter *interp, const char *event, int position) {
+    if (interp->term_mode == TERM_RECORD) {
+        fprintf(interp->out, BLUE "[headless] %s skipped at position %s\n" RESET, event, pos_text(interp, position));
+    }
+}
+
+// True unless the op at this position would have to wait for host input
+bool input_ready(NumoInterpreter *interp, int position) {
+    Instruction instr = interp->program[position];
+    if (!interp->host_input || instr.op != OP_IO || interp->input_closed) return true;
+
+    const char *data = interp->input_data + interp->input_pos;
+    size_t len = interp->input_len - interp->input_pos;
+    if (len == 0) return instr.arg != 0 && instr.arg != 1 && (instr.arg != 4 || !pause_waits(interp));
+    switch (instr.arg) {
+        case 0: { // number: skips blank lines like scanf, then needs the whole line
+            size_t i = 0;
+            while (i < len && isspace((unsigned char)data[i])) i++;
+            return i < len && memchr(data + i, '\n', len - i) != NULL;
+        }
+        case 1: return memchr(data, '\n', len) != NULL;
+        default: return true;
+    }
+}
+
+// Read a number and drop the rest of its line. Returns 1, 0 (no number)
+// or EOF (nothing but whitespace left) like scanf("%d").
+int input_read_int(NumoInterpreter *interp, int *value) {
+    input_prepare(interp);
+    if (!interp->host_input) {
+        int result = scanf("%d", value);
+        int c;
+        while ((c = getchar()) != '\n' && c != EOF);
+        return result;
+    }
+
+    // Same acceptance as scanf: whitespace, optional sign, decimal digits;
+    // out-of-range values saturate as a long, then narrow to int
+    const char *data = interp->input_data;
+    size_t pos = interp->input_pos, len = interp->input_len;
+    while (pos < len && isspace((unsigned char)data[pos])) pos++;
+    if (pos >= len) {
+        interp->input_pos = pos;
+        return EOF;
+    }
+    bool negative = data[pos] == '-';
+    size_t digits = pos + (data[pos] == '-' || data[pos] == '+');
+    unsigned long magnitude = 0;
+    bool overflow = false;
+    size_t end = digits;
+    for (; end < len && data[end] >= '0' && data[end] <= '9'; end++) {
+        unsigned digit = data[end] - '0';
+        if (magnitude > (ULONG_MAX - digit) / 10) overflow = true;
+        magnitude = overflow ? magnitude : magnitude * 10 + digit;
+    }
+    int result = 0;
+    if (end > digits) {
+        if (negative) {
+            *value = (overflow || magnitude > (unsigned long)LONG_MAX + 1) ? (int)LONG_MIN : (int)(0 - magnitude);
+        } else {
+            *value = (overflow || magnitude > LONG_MAX) ? (int)LONG_MAX : (int)magnitude;
+        }
+        result = 1;
+    }
+    // The rest of the line goes, as with the getchar loop above
+    const char *newline = memchr(data + pos, '\n', len - pos);
+    interp->input_pos = newline ? (size_t)(newline - data) + 1 : len;
+    return result;
+}
+
+// Read one line like fgets, newline included; NULL at end of input
+char *input_read_line(NumoInterpreter *interp) {
+    input_prepare(interp);
+    if (!interp->host_input) {
+        char *line = NULL;
+        size_t capacity = 0;
+        if (getline(&line, &capacity, stdin) < 0) {
+            free(line);
+            return NULL;
+        }
+        return line;
+    }
+    if (interp->input_pos >= interp->input_len) return NULL;
+
+    const char *data = interp->input_data + interp->input_pos;
+    size_t len = interp->input_len - interp->input_pos;
+    const char *newline = memchr(data, '\n', len);
+    size_t line_len = newline ? (size_t)(newline - data) + 1 : len;
+    char *line = malloc(line_len + 1);
+    if (!line) return NULL;
+    memcpy(line, data, line_len);
+    line[line_len] = '\0';
+    interp->input_pos += line_len;
+    return line;
+}
+
+// Read one character like getchar
+int input_read_char(NumoInterpreter *interp) {
+    input_prepare(interp);
+    if (!interp->host_input) {
+        return getchar();
+    }
+    if (interp->input_pos >= interp->input_len) return EOF;
+    return (unsigned char)interp->input_data[interp->input_pos++];
+}
+
+// Enhanced input/output operations
+void handle_enhanced_io(NumoInterpreter *interp, int io_type, int position) {
+    fprintf(interp->out, BLUE "Enhanced I/O operation type %d at position %s\n" RESET, io_type, pos_text(interp, position));
+
+    switch (io_type) {
+        case 0: // Input number
+            fprintf(interp->out, YELLOW "Enter a number: " RESET);
+            fflush(interp->out);
+            int input_val;
+            int status = input_read_int(interp, &input_val);
+            if (status == 1) {
+                if (interp->var_count < interp->var_capacity) {
+                    Variable *var = &interp->vars[interp->var_count];
+                    var->type = 3;
+                    name_variable(interp, var, "input_num_", position, "");
+                    var->value.int_val = input_val;
+                    fprintf(interp->out, GREEN "Stored input %d in variable %s\n" RESET, input_val, var->name);
+                    interp->var_count++;
+                }
+            } else if (status == EOF) {
+                fprintf(interp->out, YELLOW "End of input, nothing stored\n" RESET);
+            } else {
+                fprintf(interp->out, RED "Invalid input!\n" RESET);
+            }
+            break;
+        case 1: // Input string
+            fprintf(interp->out, YELLOW "Enter a string: " RESET);
+            fflush(interp->out);
+            char *input_str = input_read_line(interp);
+            if (input_str) {
+                // Remove newline if present
+                size_t length = strcspn(input_str, "\n");
+                if (interp->var_count < interp->var_capacity) {
+                    Variable *var = &interp->vars[interp->var_count];
+                    var->type = 4;
+                    name_variable(interp, var, "input_str_", position, "");
+                    if (string_set(interp, &var->value.str_val, input_str, length)) {
+                        fprintf(interp->out, GREEN "Stored input \"%.*s\" in variable %s\n" RESET, (int)length,
+                                input_str, var->name);
+                        interp->var_count++;
+                    }
+                }
+                free(input_str);
+            } else {
+                fprintf(interp->out, YELLOW "End of input, nothing stored\n" RESET);
+            }
+            break;
+        case 2: // Display variable
+            if (interp->var_count > 0) {
                 Variable *var = &interp->vars[interp->var_count - 1];
-                bool condition = false;
-                
+                fprintf(interp->out, CYAN "Display variable %s: " RESET, var->name);
                 switch (var->type) {
-                    case 3: condition = (var->value.int_val != 0); break;
-                    case 5: condition = var->value.bool_val; break;
-                    case 6: condition = (var->value.float_val != 0.0); break;
-                    default: condition = false; break;
-                }
-                
-                if (interp->stack_pointer < MAX_STACK_SIZE) {
-                    interp->stack[interp->stack_pointer].position = position;
-                    interp->stack[interp->stack_pointer].condition_result = condition ? 1 : 0;
-                    interp->stack_pointer++;
+                    case 3: fprintf(interp->out, "%lld\n", var->value.int_val); break;
+                    case 4:
+                        fprintf(interp->out, "\"");
+                        print_string(interp->out, &var->value.str_val, 0);
+                        fprintf(interp->out, "\"\n");
+                        break;
+                    case 5: fprintf(interp->out, "%s\n", var->value.bool_val ? "true" : "false"); break;
+                    case 6: fprintf(interp->out, "%.2f\n", var->value.float_val); break;
+                    case 7: print_array(interp->out, var->value.array_val); fprintf(interp->out, "\n"); break;
+                    case 8: print_bignum(interp->out, var->value.big_val); fprintf(interp->out, "\n"); break;
+                    case 9: print_dict(interp->out, var->value.dict_val, 16); fprintf(interp->out, "\n"); break;
                 }
-                
-                printf(YELLOW "IF condition evaluated to: %s\n" RESET, condition ? "TRUE" : "FALSE");
             }
             break;
-            
-        case 2: // ELSE
-            if (interp->stack_pointer > 0) {
-                int condition = interp->stack[interp->stack_pointer - 1].condition_result;
-                printf(MAGENTA "ELSE branch (condition was %s)\n" RESET, condition ? "TRUE" : "FALSE");
-            }
+        case 3: // Clear screen: the sequence clear(1) prints for xterm, without a shell
+            if (interp->term_mode == TERM_LIVE) {
+                fprintf(interp->out, "\033[H\033[2J\033[3J");
+            } else {
+                record_term_event(interp, "clear", position);
+            }
+            fprintf(interp->out, GREEN "Screen cleared\n" RESET);
+            break;
+        case 4: // Pause/Wait, only when someone can press Enter
+            if (pause_waits(interp)) {
+                fprintf(interp->out, YELLOW "Press Enter to continue..." RESET);
+                input_read_char(interp);
+            } else {
+                record_term_event(interp, "pause", position);
+            }
+            break;
+        case 5: // Random number
+            if (interp->var_count < interp->var_capacity) {
+                Variable *var = &interp->vars[interp->var_count];
+                var->type = 3;
+                name_variable(interp, var, "random_", position, "");
+                var->value.int_val = rand() % 100;
+                fprintf(interp->out, GREEN "Generated random number %lld\n" RESET, var->value.int_val);
+                interp->var_count++;
+            }
+            break;
+        case 6: // Print with color
+            set_color(interp, position % 10);
+            fprintf(interp->out, "%sColored output at position %s\n" RESET, interp->current_color,
+                    pos_text(interp, position));
+            break;
+        case 7: // Formatted output
+            fprintf(interp->out, BOLD "=== Formatted Output ===" RESET "\n");
+            fprintf(interp->out, CYAN "Position: %s\n" RESET, pos_text(interp, position));
+            fprintf(interp->out, YELLOW "Variables: %d\n" RESET, interp->var_count);
+            break;
+        case 8: // Sound/Bell
+            if (interp->term_mode == TERM_LIVE) {
+                fprintf(interp->out, "\a"); // Bell sound
+            } else {
+                record_term_event(interp, "bell", position);
+            }
+            fprintf(interp->out, MAGENTA "Sound alert at position %s\n" RESET, pos_text(interp, position));
+            break;
+        case 9: // Time/Date
+            {
+                time_t now = time(NULL);
+                char stamp[32]; // ctime_r: programs may run on scheduler threads
+                fprintf(interp->out, GREEN "Current time: %s" RESET, ctime_r(&now, stamp));
+            }
+            break;
+    }
+}
+
+// Handle math operations (digit 8), operation given by the preceding digit
+void handle_math(NumoInterpreter *interp, int operation, int position) {
+    fprintf(interp->out, MAGENTA "Math operation %d at position %s\n" RESET, operation, pos_text(interp, position));
+    handle_advanced_math(interp, operation, position);
+}
+
+// Handle file operations (digit 9)
+void handle_file_ops(NumoInterpreter *interp, int position) {
+    if (interp->limits.max_report_files > 0 && interp->report_files >= interp->limits.max_report_files) {
+        interp->limit_hit = LIMIT_REPORTS;
+        return;
+    }
+    interp->report_files++;
+    fprintf(interp->out, CYAN "Advanced file operation at position %s\n" RESET, pos_text(interp, position));
+
+    char filename[50];
+    sprintf(filename, "numo_output_%d.txt", position);
+
+    FILE *file = fopen(filename, "w");
+    if (file) {
+        fprintf(file, "=== Numo 0-9 Advanced Output Report ===\n");
+        fprintf(file, "Position: %d\n", position);
+        fprintf(file, "Variables created: %d\n", interp->var_count);
+        fprintf(file, "Stack pointer: %d\n", interp->stack_pointer);
+        fprintf(file, "Loop depth: %d\n", interp->loop_depth);
+        fprintf(file, "\n--- Variables ---\n");
+
+        for (int i = 0; i < interp->var_count; i++) {
+            Variable *var = &interp->vars[i];
+            switch (var->type) {
+                case 3:
+                    fprintf(file, "%s (int) = %lld\n", var->name, var->value.int_val);
+                    break;
+                case 4:
+                    fprintf(file, "%s (string) = \"", var->name);
+                    print_string(file, &var->value.str_val, 0);
+                    fprintf(file, "\"\n");
+                    break;
+                case 5:
+                    fprintf(file, "%s (bool) = %s\n", var->name, 
+                           var->value.bool_val ? "true" : "false");
+                    break;
+                case 6:
+                    fprintf(file, "%s (float) = %.2f\n", var->name, var->value.float_val);
+                    break;
+                case 7:
+                    fprintf(file, "%s (array) = [", var->name);
+                    for (size_t j = 0; j < var->value.array_val->length; j++) {
+                        fprintf(file, "%g%s", var->value.array_val->data[j], 
+                               (j < var->value.array_val->length - 1) ? ", " : "");
+                    }
+                    fprintf(file, "]\n");
+                    break;
+                case 8:
+                    fprintf(file, "%s (bignum) = ", var->name);
+                    print_bignum(file, var->value.big_val);
+                    fprintf(file, "\n");
+                    break;
+                case 9:
+                    fprintf(file, "%s (dict) = ", var->name);
+                    print_dict(file, var->value.dict_val, 0);
+                    fprintf(file, "\n");
+                    break;
+            }
+        }
+
+        fprintf(file, "\n--- Execution Statistics ---\n");
+        fprintf(file, "Total code length: %d\n", interp->code_length);
+        fprintf(file, "Debug mode: %s\n", interp->debug_mode ? "enabled" : "disabled");
+
+        fclose(file);
+        fprintf(interp->out, GREEN "Created advanced report: %s\n" RESET, filename);
+    }
+}
+
+// A 0/1 digit opens a binary payload if none is pending
+void mark_binary(NumoInterpreter *interp, int position) {
+    if (interp->binary_start == -1) {
+        interp->binary_start = position;
+    }
+}
+
+// A 2 ends the pending binary payload, otherwise it is a loop
+void end_binary_or_loop(NumoInterpreter *interp, int loop_kind, int position) {
+    if (interp->binary_start != -1) {
+        execute_binary(interp, interp->binary_start, position);
+        interp->binary_start = -1;
+    } else {
+        handle_loops(interp, loop_kind, position);
+    }
+}
+
+// Execute one decoded instruction
+void execute_instruction(NumoInterpreter *interp, Instruction instr, int position) {
+    switch (instr.op) {
+        case OP_BIT: mark_binary(interp, position); break;
+        case OP_TWO: end_binary_or_loop(interp, instr.arg, position); break;
+        case OP_INT_VAR: create_int_variable(interp, position, instr.arg); break;
+        case OP_FLOAT_VAR: create_float_variable(interp, position); break;
+        case OP_STRING_VAR: create_string_variable(interp, position); break;
+        case OP_DISPLAY: display_last_variable(interp); break;
+        case OP_BOOL_VAR: create_bool_variable(interp, position); break;
+        case OP_CONTROL: execution_control(interp); break;
+        case OP_CONDITIONAL: handle_conditionals(interp, instr.arg, position); break;
+        case OP_IO: handle_enhanced_io(interp, instr.arg, position); break;
+        case OP_MATH: handle_math(interp, instr.arg, position); break;
+        case OP_FILE: handle_file_ops(interp, position); break;
+        case OP_ARRAY_VAR: create_array_variable(interp, position); break;
+        case OP_DICT: handle_dict_op(interp, instr.arg, position); break;
+        default:
+            fprintf(interp->out, RED "Unknown digit: %c at position %s\n" RESET, interp->code[position],
+                    pos_text(interp, position));
+            break;
+    }
+}
+
+// Execute the instruction stored at a position (JIT fallback template)
+void execute_instruction_at(NumoInterpreter *interp, int position) {
+    execute_instruction(interp, interp->program[position], position);
+}
+
+// Instructions after which execution may not continue at the next digit
+bool instruction_may_jump(NumoInterpreter *interp, int position) {
+    Instruction instr = interp->program[position];
+    if (instr.op == OP_CONTROL || is_loop_marker(interp, position)) return true;
+    return instr.op == OP_CONDITIONAL && (instr.arg == 1 || instr.arg == 2) &&
+           interp->jump_table[position] != -1;
+}
+
+// Positions execution may continue at after a jumping instruction
+int branch_targets(NumoInterpreter *interp, int position, int *targets) {
+    Instruction instr = interp->program[position];
+    int target = interp->jump_table[position];
+    int count = 0;
+
+    if (instr.op == OP_CONTROL && position + 1 < interp->code_length) {
+        targets[count++] = position + 2;
+    } else if (is_loop_marker(interp, position)) {
+        // Header skips past its END-LOOP; END-LOOP returns after its header
+        targets[count++] = target + 1;
+    } else if (instr.op == OP_CONDITIONAL && instr.arg == 1 && target != -1) {
+        targets[count++] = (interp->program[target].arg == 2) ? target + 1 : target;
+    } else if (instr.op == OP_CONDITIONAL && instr.arg == 2 && target != -1) {
+        targets[count++] = target;
+    }
+    return count;
+}
+
+// x86-64 template JIT: each instruction becomes an inline template or a
+// direct call into its runtime helper, so there is no dispatch at all.
+// Generated code: int fn(NumoInterpreter *interp, void *entry) returns 0
+// when the program ends, 1 when an instruction moved interp->position.
+#if defined(__x86_64__)
+
+void jit_emit_byte(unsigned char **p, unsigned char byte) {
+    *(*p)++ = byte;
+}
+
+void jit_emit_u32(unsigned char **p, uint32_t value) {
+    memcpy(*p, &value, 4);
+    *p += 4;
+}
+
+void jit_emit_u64(unsigned char **p, uint64_t value) {
+    memcpy(*p, &value, 8);
+    *p += 8;
+}
+
+// mov rdi, rbx; mov esi, a; mov edx, b; movabs rax, fn; call rax
+void jit_emit_call(unsigned char **p, void *fn, int argc, int a, int b) {
+    jit_emit_byte(p, 0x48); jit_emit_byte(p, 0x89); jit_emit_byte(p, 0xDF);
+    if (argc >= 1) { jit_emit_byte(p, 0xBE); jit_emit_u32(p, a); }
+    if (argc >= 2) { jit_emit_byte(p, 0xBA); jit_emit_u32(p, b); }
+    jit_emit_byte(p, 0x48); jit_emit_byte(p, 0xB8); jit_emit_u64(p, (uint64_t)(uintptr_t)fn);
+    jit_emit_byte(p, 0xFF); jit_emit_byte(p, 0xD0);
+}
+
+// mov dword [rbx + field], value
+void jit_emit_store(unsigned char **p, size_t field, int value) {
+    jit_emit_byte(p, 0xC7); jit_emit_byte(p, 0x83);
+    jit_emit_u32(p, field); jit_emit_u32(p, value);
+}
+
+// cmp dword [rbx + field], value
+void jit_emit_compare(unsigned char **p, size_t field, int value) {
+    jit_emit_byte(p, 0x81); jit_emit_byte(p, 0xBB);
+    jit_emit_u32(p, field); jit_emit_u32(p, value);
+}
+
+bool jit_compile(NumoInterpreter *interp) {
+    size_t capacity = (size_t)interp->code_length * 64 + 64;
+    unsigned char *code = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED) return false;
+
+    size_t position_field = offsetof(NumoInterpreter, position);
+    size_t binary_field = offsetof(NumoInterpreter, binary_start);
+    unsigned char *p = code;
+
+    // Entry: push rbx; mov rbx, rdi; jmp rsi
+    jit_emit_byte(&p, 0x53);
+    jit_emit_byte(&p, 0x48); jit_emit_byte(&p, 0x89); jit_emit_byte(&p, 0xFB);
+    jit_emit_byte(&p, 0xFF); jit_emit_byte(&p, 0xE6);
+
+    // Exit back to the interpreter: mov eax, 1; pop rbx; ret
+    unsigned char *diverged = p;
+    jit_emit_byte(&p, 0xB8); jit_emit_u32(&p, 1);
+    jit_emit_byte(&p, 0x5B); jit_emit_byte(&p, 0xC3);
+
+    for (int i = 0; i < interp->code_length; i++) {
+        Instruction instr = interp->program[i];
+        interp->jit_offsets[i] = p - code;
+
+        if (instruction_may_jump(interp, i)) {
+            jit_emit_store(&p, position_field, i);
+        }
+
+        switch (instr.op) {
+            case OP_BIT:
+                // Inline: if (binary_start == -1) binary_start = i;
+                jit_emit_compare(&p, binary_field, -1);
+                jit_emit_byte(&p, 0x75); jit_emit_byte(&p, 10);
+                jit_emit_store(&p, binary_field, i);
+                break;
+            case OP_TWO: jit_emit_call(&p, end_binary_or_loop, 2, instr.arg, i); break;
+            case OP_INT_VAR: jit_emit_call(&p, create_int_variable, 2, i, instr.arg); break;
+            case OP_FLOAT_VAR: jit_emit_call(&p, create_float_variable, 1, i, 0); break;
+            case OP_STRING_VAR: jit_emit_call(&p, create_string_variable, 1, i, 0); break;
+            case OP_DISPLAY: jit_emit_call(&p, display_last_variable, 0, 0, 0); break;
+            case OP_BOOL_VAR: jit_emit_call(&p, create_bool_variable, 1, i, 0); break;
+            case OP_CONTROL: jit_emit_call(&p, execution_control, 0, 0, 0); break;
+            case OP_CONDITIONAL: jit_emit_call(&p, handle_conditionals, 2, instr.arg, i); break;
+            case OP_IO: jit_emit_call(&p, handle_enhanced_io, 2, instr.arg, i); break;
+            case OP_MATH: jit_emit_call(&p, handle_math, 2, instr.arg, i); break;
+            case OP_FILE: jit_emit_call(&p, handle_file_ops, 1, i, 0); break;
+            default: jit_emit_call(&p, execute_instruction_at, 1, i, 0); break;
+        }
+
+        if (instruction_may_jump(interp, i)) {
+            // jne diverged
+            jit_emit_compare(&p, position_field, i);
+            jit_emit_byte(&p, 0x0F); jit_emit_byte(&p, 0x85);
+            jit_emit_u32(&p, (uint32_t)(diverged - (p + 4)));
+        }
+    }
+
+    // End of program: position = code_length; xor eax, eax; pop rbx; ret
+    interp->jit_offsets[interp->code_length] = p - code;
+    jit_emit_store(&p, position_field, interp->code_length);
+    jit_emit_byte(&p, 0x31); jit_emit_byte(&p, 0xC0);
+    jit_emit_byte(&p, 0x5B); jit_emit_byte(&p, 0xC3);
+
+    if (mprotect(code, capacity, PROT_READ | PROT_EXEC) != 0) {
+        munmap(code, capacity);
+        return false;
+    }
+    interp->jit_code = code;
+    interp->jit_size = capacity;
+    return true;
+}
+
+#else
+
+// Other architectures keep using the interpreter
+bool jit_compile(NumoInterpreter *interp) {
+    return false;
+}
+
+#endif
+
+void free_jit(NumoInterpreter *interp) {
+    if (interp->jit_code) {
+        munmap(interp->jit_code, interp->jit_size);
+        interp->jit_code = NULL;
+        interp->jit_size = 0;
+    }
+}
+
+// Run compiled code from the current position, re-entering after every
+// instruction that moved the position
+void jit_run(NumoInterpreter *interp) {
+    int (*entry)(NumoInterpreter *, void *) = (int (*)(NumoInterpreter *, void *))interp->jit_code;
+    while (interp->position < interp->code_length) {
+        if (entry(interp, interp->jit_code + interp->jit_offsets[interp->position]) == 0) break;
+        interp->position++;
+    }
+}
+
+// Execute the instruction at the current position and advance past it
+void execute_step(NumoInterpreter *interp) {
+    if (interp->debug_mode) {
+        fprintf(interp->out, MAGENTA "Position %s: Processing digit '%c'\n" RESET,
+                pos_text(interp, interp->position), interp->code[interp->position]);
+    }
+    execute_instruction(interp, interp->program[interp->position], interp->position);
+    interp->position++;
+    interp->instructions_executed++;
+}
+
+// With base >= 0 the position in the name counts relative to base
+uint64_t hash_variable(uint64_t hash, Variable *var, int base) {
+    hash = hash_bytes(hash, &var->type, sizeof(var->type));
+    if (base >= 0 && var->origin >= 0) {
+        int offset = var->origin - base;
+        const char *rest = var->name + var->origin_at + strspn(var->name + var->origin_at, "0123456789");
+        hash = hash_bytes(hash, var->name, var->origin_at);
+        hash = hash_bytes(hash, &offset, sizeof(offset));
+        hash = hash_bytes(hash, rest, strlen(rest));
+    } else {
+        hash = hash_bytes(hash, var->name, strlen(var->name));
+    }
+    switch (var->type) {
+        case 3: hash = hash_bytes(hash, &var->value.int_val, sizeof(var->value.int_val)); break;
+        case 4:
+            hash = var->value.str_val.rope ? rope_hash(hash, var->value.str_val.rope)
+                                           : hash_bytes(hash, var->value.str_val.chars, strlen(var->value.str_val.chars));
+            break;
+        case 5: hash = hash_bytes(hash, &var->value.bool_val, sizeof(bool)); break;
+        case 6: hash = hash_bytes(hash, &var->value.float_val, sizeof(double)); break;
+        case 8:
+            hash = hash_bytes(hash, &var->value.big_val->sign, sizeof(int));
+            hash = hash_bytes(hash, var->value.big_val->limbs, var->value.big_val->len * sizeof(uint32_t));
+            break;
+        case 7: hash = hash_bytes(hash, var->value.array_val->data, var->value.array_val->length * sizeof(double)); break;
+        case 9: hash = hash_dict(hash, var->value.dict_val); break;
+    }
+    return hash;
+}
+
+// Variables a pure handler can read: the last one, the two most recent
+// numeric ones and (with --strings) the three most recent strings
+int memo_read_set(NumoInterpreter *interp, Variable **found) {
+    int count = 0;
+    if (interp->var_count > 0) {
+        found[count++] = &interp->vars[interp->var_count - 1];
+    }
+    int found_vars = 0;
+    for (int i = interp->var_count - 1; i >= 0 && found_vars < 2; i--) {
+        int type = interp->vars[i].type;
+        if (type == 3 || type == 6 || type == 7 || type == 8) {
+            found[count++] = &interp->vars[i];
+            found_vars++;
+        }
+    }
+    if (interp->strings_enabled) {
+        count += recent_strings(interp, found + count, 3);
+    }
+    return count;
+}
+
+// A segment is relocatable unless a handler turns a position into data
+// other than a shown number or a name: string variables hold "Hello_<pos>"
+bool segment_relocatable(NumoInterpreter *interp, int start, int end) {
+    for (int pos = start; pos < end; pos++) {
+        if (interp->program[pos].op == OP_STRING_VAR) return false;
+    }
+    return true;
+}
+
+// Key = segment text (with the neighbour digits the handlers peek at) plus
+// every piece of prior state a pure handler can read. Handlers only see
+// positions modulo 100 (floats, I/O types, booleans, array elements), so a
+// relocatable key holds start % 100 and every other position relative to
+// start: the same code in the same state then hits at any offset.
+uint64_t memo_key(NumoInterpreter *interp, int start, int end, bool relocatable) {
+    uint64_t hash = FNV_OFFSET;
+    int from = (start > 0) ? start - 1 : start;
+    int to = (end < interp->code_length) ? end + 1 : end;
+    bool at_program_start = (start == 0);
+    bool at_program_end = (end == interp->code_length);
+    int base = relocatable ? start : -1;
+
+    hash = hash_bytes(hash, &relocatable, sizeof(relocatable));
+    if (relocatable) {
+        int residue = start % 100;
+        hash = hash_bytes(hash, &residue, sizeof(residue));
+        hash = hash_bytes(hash, &at_program_start, sizeof(at_program_start));
+    } else {
+        hash = hash_bytes(hash, &start, sizeof(start));
+    }
+    hash = hash_bytes(hash, &at_program_end, sizeof(at_program_end));
+    hash = hash_bytes(hash, interp->code + from, to - from);
+    for (int pos = start; pos < end; pos++) {
+        int target = interp->jump_table[pos];
+        if (relocatable && target != -1) target -= start;
+        hash = hash_bytes(hash, &target, sizeof(target));
+    }
+
+    hash = hash_bytes(hash, &interp->var_count, sizeof(interp->var_count));
+    Variable *read[6];
+    int count = memo_read_set(interp, read);
+    for (int i = 0; i < count; i++) {
+        hash = hash_variable(hash, read[i], base);
+    }
+
+    hash = hash_bytes(hash, &interp->stack_pointer, sizeof(interp->stack_pointer));
+    for (int i = 0; i < interp->stack_pointer; i++) {
+        StackFrame frame = interp->stack[i];
+        if (relocatable) frame.position -= start;
+        hash = hash_bytes(hash, &frame, sizeof(frame));
+    }
+    hash = hash_bytes(hash, &interp->loop_depth, sizeof(interp->loop_depth));
+    hash = hash_bytes(hash, interp->current_color, strlen(interp->current_color));
+    hash = hash_bytes(hash, &interp->debug_mode, sizeof(interp->debug_mode));
+    int binary_start = interp->binary_start;
+    if (relocatable && binary_start != -1) binary_start -= start;
+    hash = hash_bytes(hash, &binary_start, sizeof(binary_start));
+    if (interp->binary_start != -1) {
+        hash = hash_bytes(hash, interp->code + interp->binary_start, start - interp->binary_start);
+    }
+    return hash;
+}
+
+MemoEntry *memo_lookup(NumoInterpreter *interp, uint64_t key, int start) {
+    for (MemoEntry *entry = interp->memo_buckets[key % MEMO_BUCKETS]; entry; entry = entry->next) {
+        if (entry->key == key && (entry->relocatable || entry->start == start)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+void memo_insert(NumoInterpreter *interp, MemoEntry *entry) {
+    int bucket = entry->key % MEMO_BUCKETS;
+    entry->next = interp->memo_buckets[bucket];
+    interp->memo_buckets[bucket] = entry;
+}
+
+void free_memo_table(NumoInterpreter *interp) {
+    for (int i = 0; i < MEMO_BUCKETS; i++) {
+        MemoEntry *entry = interp->memo_buckets[i];
+        while (entry) {
+            MemoEntry *next = entry->next;
+            free(entry->output);
+            free(entry->new_vars);
+            free(entry->frames);
+            free(entry);
+            entry = next;
+        }
+        interp->memo_buckets[i] = NULL;
+    }
+}
+
+// Apply a recorded segment: output bytes, new variables and stack frames.
+// A relocatable entry recorded at another start moves every position by
+// the distance between the two.
+void replay_memo_entry(NumoInterpreter *interp, MemoEntry *entry) {
+    int start = interp->position;
+    int shift = entry->relocatable ? start - entry->start : 0;
+    if (entry->relocatable) {
+        write_positions(interp->out, entry->output, entry->output_len, entry->tag, start);
+    } else {
+        fwrite(entry->output, 1, entry->output_len, interp->out);
+    }
+    Variable *vars = &interp->vars[interp->var_count];
+    memcpy(vars, entry->new_vars, entry->new_var_count * sizeof(Variable));
+    interp->var_count += entry->new_var_count;
+    if (entry->relocatable) {
+        for (int i = 0; i < entry->new_var_count; i++) {
+            char number[16];
+            vars[i].origin += shift;
+            snprintf(number, sizeof(number), "%d", vars[i].origin);
+            rename_position(&vars[i], number);
+        }
+    }
+    memcpy(interp->stack, entry->frames, entry->frame_count * sizeof(StackFrame));
+    for (int i = 0; i < entry->frame_count; i++) {
+        interp->stack[i].position += shift;
+    }
+    interp->stack_pointer = entry->frame_count;
+    interp->loop_depth = entry->loop_depth;
+    interp->binary_start = (entry->binary_start != -1) ? entry->binary_start + shift : -1;
+    strcpy(interp->current_color, entry->color);
+    interp->instructions_executed += entry->end_position + shift - start;
+    interp->position = entry->end_position + shift;
+}
+
+// A memo step runs its whole segment at once, so it must not cross a limit
+// that stepping would stop at partway. A hit knows its variables and
+// output; a recording counts one variable per creating digit (a split may
+// add more, so it steps) and OUTPUT_OP_BUDGET bytes per digit.
+bool segment_within_limits(NumoInterpreter *interp, int start, int end, MemoEntry *entry) {
+    ResourceLimits *limits = &interp->limits;
+    long length = end - start;
+    if (limits->max_instructions > 0 && interp->instructions_executed + length > limits->max_instructions) {
+        return false;
+    }
+    long new_vars = 0;
+    long output = length * OUTPUT_OP_BUDGET;
+    if (entry) {
+        new_vars = entry->new_var_count;
+        output = (long)entry->output_len;
+    } else {
+        for (int i = start; i < end; i++) {
+            Instruction instr = interp->program[i];
+            if (instr.op == OP_TWO && instr.arg == 9 && interp->strings_enabled) return false;
+            if (may_create_variable(instr)) new_vars++;
+        }
+    }
+    if (limits->max_variables > 0 && interp->var_count + new_vars > limits->max_variables) return false;
+    return limits->max_output_bytes <= 0 || interp->output_bytes + output <= limits->max_output_bytes;
+}
+
+// Run the pure segment at the current position from the memo cache, or
+// execute it while recording its effects. Returns false if not memoizable,
+// or if the segment could cross a resource limit.
+bool run_memoized_segment(NumoInterpreter *interp) {
+    int start = interp->position;
+    int end = interp->segment_end[start];
+    if (end - start < MEMO_MIN_SEGMENT) return false;
+
+    bool relocatable = segment_relocatable(interp, start, end);
+    uint64_t key = memo_key(interp, start, end, relocatable);
+    MemoEntry *entry = memo_lookup(interp, key, start);
+    // An entry from a --memo-file must also fit this program's store
+    if (entry && interp->var_count + entry->new_var_count > interp->var_capacity) {
+        entry = NULL;
+    }
+    if (interp->limits_active && !segment_within_limits(interp, start, end, entry)) {
+        return false;
+    }
+    if (entry) {
+        replay_memo_entry(interp, entry);
+        interp->memo_hits++;
+        return true;
+    }
+
+    char *buffer = NULL;
+    size_t buffer_len = 0;
+    FILE *capture = open_memstream(&buffer, &buffer_len);
+    if (!capture) return false;
+
+    // A relocatable recording shows positions as markers, including those
+    // in the names of the variables the key covers
+    Variable *read[6];
+    int read_count = 0;
+    if (relocatable) {
+        interp->reloc_base = start;
+        read_count = memo_read_set(interp, read);
+        for (int i = 0; i < read_count; i++) {
+            rename_position(read[i], pos_text(interp, read[i]->origin));
+        }
+    }
+    int var_base = interp->var_count;
+    FILE *real_out = interp->out;
+    interp->out = capture;
+    while (interp->position < end) {
+        execute_step(interp);
+    }
+    fclose(capture);
+    interp->out = real_out;
+    interp->reloc_base = -1;
+
+    // Bignums, arrays, dictionaries and heap strings live in the run's own
+    // storage, so their segments are not cached
+    bool cacheable = true;
+    for (int i = var_base; i < interp->var_count; i++) {
+        if (interp->vars[i].type == 7 || interp->vars[i].type == 8 || interp->vars[i].type == 9 ||
+            (interp->vars[i].type == 4 && interp->vars[i].value.str_val.rope)) {
+            cacheable = false;
+        }
+    }
+    entry = cacheable ? calloc(1, sizeof(MemoEntry)) : NULL;
+    if (entry) {
+        entry->new_var_count = interp->var_count - var_base;
+        entry->new_vars = malloc(entry->new_var_count * sizeof(Variable) + 1);
+        memcpy(entry->new_vars, &interp->vars[var_base], entry->new_var_count * sizeof(Variable));
+    }
+    if (relocatable) {
+        write_positions(interp->out, buffer, buffer_len, interp->reloc_tag, start);
+        for (int i = 0; i < read_count; i++) {
+            rename_position(read[i], pos_text(interp, read[i]->origin));
+        }
+        for (int i = var_base; i < interp->var_count; i++) {
+            rename_position(&interp->vars[i], pos_text(interp, interp->vars[i].origin));
+        }
+    } else {
+        fwrite(buffer, 1, buffer_len, interp->out);
+    }
+    if (!entry) {
+        free(buffer);
+        return true;
+    }
+
+    entry->key = key;
+    entry->start = start;
+    entry->end_position = interp->position;
+    entry->output = buffer;
+    entry->output_len = buffer_len;
+    entry->relocatable = relocatable;
+    entry->tag = interp->reloc_tag;
+    entry->frame_count = interp->stack_pointer;
+    entry->frames = malloc(entry->frame_count * sizeof(StackFrame) + 1);
+    memcpy(entry->frames, interp->stack, entry->frame_count * sizeof(StackFrame));
+    entry->loop_depth = interp->loop_depth;
+    entry->binary_start = interp->binary_start;
+    strcpy(entry->color, interp->current_color);
+    memo_insert(interp, entry);
+    interp->memo_misses++;
+    return true;
+}
+
+// Memo file: magic, variable record size, entry count, then per entry the
+// fixed fields followed by output bytes, variables and stack frames
+#define MEMO_FILE_MAGIC "NUMOMEM4"
+
+bool save_memo_file(NumoInterpreter *interp, const char *filename) {
+    FILE *file = fopen(filename, "wb");
+    if (!file) {
+        fprintf(interp->out, RED "Error: Cannot write memo file %s\n" RESET, filename);
+        return false;
+    }
+
+    int count = 0;
+    for (int i = 0; i < MEMO_BUCKETS; i++) {
+        for (MemoEntry *entry = interp->memo_buckets[i]; entry; entry = entry->next) count++;
+    }
+    int var_size = sizeof(Variable);
+    fwrite(MEMO_FILE_MAGIC, 1, 8, file);
+    fwrite(&var_size, sizeof(int), 1, file);
+    fwrite(&count, sizeof(int), 1, file);
+
+    for (int i = 0; i < MEMO_BUCKETS; i++) {
+        for (MemoEntry *entry = interp->memo_buckets[i]; entry; entry = entry->next) {
+            fwrite(&entry->key, sizeof(entry->key), 1, file);
+            fwrite(&entry->start, sizeof(int), 1, file);
+            fwrite(&entry->end_position, sizeof(int), 1, file);
+            fwrite(&entry->output_len, sizeof(size_t), 1, file);
+            fwrite(&entry->new_var_count, sizeof(int), 1, file);
+            fwrite(&entry->frame_count, sizeof(int), 1, file);
+            fwrite(&entry->loop_depth, sizeof(int), 1, file);
+            fwrite(&entry->binary_start, sizeof(int), 1, file);
+            fwrite(entry->color, 1, sizeof(entry->color), file);
+            fwrite(&entry->relocatable, sizeof(bool), 1, file);
+            fwrite(&entry->tag, sizeof(uint32_t), 1, file);
+            fwrite(entry->output, 1, entry->output_len, file);
+            fwrite(entry->new_vars, sizeof(Variable), entry->new_var_count, file);
+            fwrite(entry->frames, sizeof(StackFrame), entry->frame_count, file);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+// A missing memo file is not an error: the first run creates it
+bool load_memo_file(NumoInterpreter *interp, const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) return false;
+
+    char magic[8];
+    int var_size = 0, count = 0;
+    if (fread(magic, 1, 8, file) != 8 || memcmp(magic, MEMO_FILE_MAGIC, 8) != 0 ||
+        fread(&var_size, sizeof(int), 1, file) != 1 || var_size != (int)sizeof(Variable) ||
+        fread(&count, sizeof(int), 1, file) != 1) {
+        fprintf(interp->out, RED "Warning: Ignoring invalid memo file %s\n" RESET, filename);
+        fclose(file);
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        MemoEntry *entry = calloc(1, sizeof(MemoEntry));
+        bool ok = entry &&
+            fread(&entry->key, sizeof(entry->key), 1, file) == 1 &&
+            fread(&entry->start, sizeof(int), 1, file) == 1 &&
+            fread(&entry->end_position, sizeof(int), 1, file) == 1 &&
+            fread(&entry->output_len, sizeof(size_t), 1, file) == 1 &&
+            fread(&entry->new_var_count, sizeof(int), 1, file) == 1 &&
+            fread(&entry->frame_count, sizeof(int), 1, file) == 1 &&
+            fread(&entry->loop_depth, sizeof(int), 1, file) == 1 &&
+            fread(&entry->binary_start, sizeof(int), 1, file) == 1 &&
+            fread(entry->color, 1, sizeof(entry->color), file) == sizeof(entry->color) &&
+            fread(&entry->relocatable, sizeof(bool), 1, file) == 1 &&
+            fread(&entry->tag, sizeof(uint32_t), 1, file) == 1 &&
+            entry->new_var_count >= 0 && entry->new_var_count <= MAX_VARIABLES &&
+            entry->frame_count >= 0 && entry->frame_count <= MAX_STACK_SIZE;
+        if (ok) {
+            entry->output = malloc(entry->output_len + 1);
+            entry->new_vars = malloc(entry->new_var_count * sizeof(Variable) + 1);
+            entry->frames = malloc(entry->frame_count * sizeof(StackFrame) + 1);
+            ok = entry->output && entry->new_vars && entry->frames &&
+                fread(entry->output, 1, entry->output_len, file) == entry->output_len &&
+                fread(entry->new_vars, sizeof(Variable), entry->new_var_count, file) == (size_t)entry->new_var_count &&
+                fread(entry->frames, sizeof(StackFrame), entry->frame_count, file) == (size_t)entry->frame_count;
+        }
+        if (!ok) {
+            if (entry) {
+                free(entry->output);
+                free(entry->new_vars);
+                free(entry->frames);
+                free(entry);
+            }
+            fprintf(interp->out, RED "Warning: Memo file %s is truncated\n" RESET, filename);
+            break;
+        }
+        memo_insert(interp, entry);
+    }
+    fclose(file);
+    return true;
+}
+
+// Constant folding / partial evaluation: everything before the first impure
+// digit depends only on the program text (neighbour digits and positions),
+// so it is evaluated once at load time, math results and binary decodes
+// included. Execution then resumes from the first input-dependent digit.
+bool fold_static_prefix(NumoInterpreter *interp) {
+    int end = (interp->code_length > 0) ? interp->segment_end[0] : 0;
+
+    FILE *capture = open_memstream(&interp->fold_output, &interp->fold_output_len);
+    if (!capture) return false;
+
+    FILE *real_out = interp->out;
+    interp->out = capture;
+    while (interp->position < end) {
+        execute_step(interp);
+    }
+    fclose(capture);
+    interp->out = real_out;
+
+    interp->fold_position = interp->position;
+    interp->folded = true;
+    return true;
+}
+
+// Banner printed before execution
+void print_run_header(NumoInterpreter *interp) {
+    fprintf(interp->out, BOLD GREEN "Starting Numo 0-9 Advanced Interpretation...\n" RESET);
+    fprintf(interp->out, CYAN "Code length: %d characters\n" RESET, interp->code_length);
+    if (interp->debug_mode) {
+        fprintf(interp->out, CYAN "Code: %s\n" RESET, interp->code);
+    }
+    fprintf(interp->out, YELLOW "==================================================\n" RESET);
+}
+
+// Flush any pending binary payload and print the run summary
+void finish_run(NumoInterpreter *interp) {
+    // Execute any remaining binary code
+    if (interp->binary_start != -1) {
+        execute_binary(interp, interp->binary_start, interp->position);
+    }
+
+    fprintf(interp->out, BOLD GREEN "\nProgram execution completed successfully!\n" RESET);
+    fprintf(interp->out, YELLOW "Variables created: %d\n" RESET, interp->var_count);
+    fprintf(interp->out, CYAN "Stack operations: %d\n" RESET, interp->stack_pointer);
+    fprintf(interp->out, MAGENTA "Final position: %d\n" RESET, interp->position);
+}
+
+// Seconds since interpret() started
+double run_seconds(NumoInterpreter *interp) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - interp->run_start.tv_sec) + (now.tv_nsec - interp->run_start.tv_nsec) / 1e9;
+}
+
+// Check the per-run limits between steps. Output and report files are
+// flagged where they happen; the clock is only read every
+// LIMIT_CLOCK_INTERVAL checks to keep the dispatch loop cheap.
+bool within_limits(NumoInterpreter *interp) {
+    ResourceLimits *limits = &interp->limits;
+    if (interp->limit_hit != LIMIT_NONE) return false;
+
+    if (limits->max_instructions > 0 && interp->position < interp->code_length &&
+        interp->instructions_executed >= limits->max_instructions) {
+        interp->limit_hit = LIMIT_INSTRUCTIONS;
+    } else if (limits->max_variables > 0 && interp->var_count > limits->max_variables) {
+        interp->limit_hit = LIMIT_VARIABLES;
+    } else if (limits->max_seconds > 0 && --interp->clock_countdown <= 0) {
+        interp->clock_countdown = LIMIT_CLOCK_INTERVAL;
+        if (run_seconds(interp) > limits->max_seconds) {
+            interp->limit_hit = LIMIT_TIME;
+        }
+    }
+    return interp->limit_hit == LIMIT_NONE;
+}
+
+// Exit code for a run stopped by a limit (10-14), 0 otherwise
+int limit_exit_code(LimitKind kind) {
+    return kind == LIMIT_NONE ? 0 : 9 + kind;
+}
+
+// Summary line for a run stopped by a limit, on stderr since stdout may
+// be the exhausted resource
+void report_limit(NumoInterpreter *interp) {
+    ResourceLimits *limits = &interp->limits;
+    char value[64];
+    const char *name = "";
+    switch (interp->limit_hit) {
+        case LIMIT_INSTRUCTIONS:
+            name = "instructions";
+            snprintf(value, sizeof(value), "%ld", limits->max_instructions);
             break;
-            
-        case 3: // WHILE loop
-            if (interp->var_count > 0) {
-                Variable *var = &interp->vars[interp->var_count - 1];
-                bool condition = (var->type == 3) ? (var->value.int_val > 0) : true;
-                
-                if (condition && interp->loop_depth < 10) {
-                    interp->loop_depth++;
-                    printf(GREEN "WHILE loop started (depth: %d)\n" RESET, interp->loop_depth);
-                } else {
-                    printf(RED "WHILE loop condition false or max depth reached\n" RESET);
-                }
-            }
+        case LIMIT_TIME:
+            name = "wall time";
+            snprintf(value, sizeof(value), "%.3fs", limits->max_seconds);
             break;
-            
-        case 4: // FOR loop
-            if (interp->var_count > 0) {
-                Variable *var = &interp->vars[interp->var_count - 1];
-                int iterations = (var->type == 3) ? var->value.int_val : 3;
-                
-                printf(CYAN "FOR loop with %d iterations\n" RESET, iterations);
-                
-                for (int i = 0; i < iterations && i < 10; i++) {
-                    printf(YELLOW "FOR iteration %d/%d\n" RESET, i + 1, iterations);
-                }
-            }
+        case LIMIT_VARIABLES:
+            name = "variables";
+            snprintf(value, sizeof(value), "%d", limits->max_variables);
             break;
-            
-        case 5: // SWITCH-CASE
-            if (interp->var_count > 0) {
-                Variable *var = &interp->vars[interp->var_count - 1];
-                int case_value = (var->type == 3) ? var->value.int_val : 0;
-                
-                printf(BLUE "SWITCH-CASE with value: %d\n" RESET, case_value);
-                
-                switch (case_value % 5) {
-                    case 0: printf(GREEN "CASE 0: Default case\n" RESET); break;
-                    case 1: printf(YELLOW "CASE 1: First case\n" RESET); break;
-                    case 2: printf(MAGENTA "CASE 2: Second case\n" RESET); break;
-                    case 3: printf(CYAN "CASE 3: Third case\n" RESET); break;
-                    case 4: printf(RED "CASE 4: Fourth case\n" RESET); break;
-                }
-            }
+        case LIMIT_OUTPUT:
+            name = "output bytes";
+            snprintf(value, sizeof(value), "%ld", limits->max_output_bytes);
             break;
-            
-        default:
-            printf(GREEN "Basic conditional operation\n" RESET);
+        case LIMIT_REPORTS:
+            name = "report files";
+            snprintf(value, sizeof(value), "%d", limits->max_report_files);
             break;
+        case LIMIT_NONE:
+            return;
     }
+    fprintf(stderr, RED "Resource limit exceeded: %s (limit %s) after %ld instructions, position %d, exit code %d\n" RESET,
+            name, value, interp->instructions_executed, interp->position, limit_exit_code(interp->limit_hit));
 }
 
-// Handle loops and iterations (digit 2) - NEW
-void handle_loops(NumoInterpreter *interp, int position) {
-    int prev_digit = (position > 0) ? interp->code[position - 1] - '0' : 0;
-    
-    printf(CYAN "Loop/Iteration operation (previous digit: %d) at position %d\n" RESET, prev_digit, position);
-    
-    switch (prev_digit) {
-        case 1: // Simple FOR loop
-            printf(YELLOW "Simple FOR loop (3 iterations)\n" RESET);
-            for (int i = 0; i < 3; i++) {
-                printf(GREEN "  Iteration %d\n" RESET, i + 1);
-            }
-            break;
-            
-        case 3: // WHILE loop based on variable
-            if (interp->var_count > 0) {
-                Variable *var = &interp->vars[interp->var_count - 1];
-                int count = (var->type == 3) ? var->value.int_val : 2;
-                
-                printf(MAGENTA "WHILE loop with %d iterations\n" RESET, count);
-                int i = 0;
-                while (i < count && i < 5) {
-                    printf(BLUE "  WHILE iteration %d\n" RESET, i + 1);
-                    i++;
-                }
+// Hard stop for the wall-time limit when a single step blocks (input,
+// pause); the dispatch loop check covers everything else
+void wall_time_watchdog(int sig) {
+    (void)sig;
+    static const char message[] = RED "Resource limit exceeded: wall time (watchdog), exit code 11\n" RESET;
+    write(STDERR_FILENO, message, sizeof(message) - 1);
+    _exit(limit_exit_code(LIMIT_TIME));
+}
+
+// Arm the watchdog one second after the soft limit
+void arm_wall_time_watchdog(double seconds) {
+    struct itimerval timer = { { 0, 0 }, { 0, 0 } };
+    seconds += 1.0;
+    timer.it_value.tv_sec = (time_t)seconds;
+    timer.it_value.tv_usec = (suseconds_t)((seconds - (double)timer.it_value.tv_sec) * 1e6);
+    signal(SIGALRM, wall_time_watchdog);
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+// Output stream wrapper that counts bytes and drops everything past the
+// output limit. Line buffered so prompts still show before input reads.
+ssize_t limited_output_write(void *cookie, const char *buf, size_t size) {
+    NumoInterpreter *interp = cookie;
+    long room = interp->limits.max_output_bytes - interp->output_bytes;
+    size_t len = size;
+    if ((long)len > room) {
+        len = (room > 0) ? (size_t)room : 0;
+        if (interp->limit_hit == LIMIT_NONE) {
+            interp->limit_hit = LIMIT_OUTPUT;
+        }
+    }
+    fwrite(buf, 1, len, interp->sink);
+    fflush(interp->sink);
+    interp->output_bytes += len;
+    return size;
+}
+
+bool open_output_limit(NumoInterpreter *interp) {
+    cookie_io_functions_t io = { NULL, limited_output_write, NULL, NULL };
+    FILE *stream = fopencookie(interp, "w", io);
+    if (!stream) return false;
+    setvbuf(stream, NULL, _IOLBF, BUFSIZ);
+    interp->sink = interp->out;
+    interp->out = stream;
+    return true;
+}
+
+void close_output_limit(NumoInterpreter *interp) {
+    if (!interp->sink) return;
+    fclose(interp->out);
+    interp->out = interp->sink;
+    interp->sink = NULL;
+}
+
+// Pipelined run (--pipeline): a reader thread loads and filters the file,
+// the interpreter thread decodes and then executes, and a writer thread
+// does the output syscalls. The stages hand off heap blocks through
+// lock-free single-producer/single-consumer rings; NULL ends a stream.
+#define RING_SLOTS 64
+#define PIPE_BLOCK_SIZE 65536
+
+typedef struct {
+    void *slots[RING_SLOTS];
+    _Atomic size_t head;  // next slot to read, advanced by the consumer
+    _Atomic size_t tail;  // next slot to fill, advanced by the producer
+} SpscRing;
+
+typedef struct {
+    size_t length;
+    char data[];
+} PipeBlock;
+
+// Spin briefly, then sleep, so a waiting stage does not starve the others
+// on a machine with fewer cores than stages
+void ring_wait(int *spins) {
+    if (++*spins < 64) {
+        sched_yield();
+    } else {
+        struct timespec pause = { 0, 50000 };
+        nanosleep(&pause, NULL);
+    }
+}
+
+void ring_push(SpscRing *ring, void *item) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    int spins = 0;
+    while (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == RING_SLOTS) ring_wait(&spins);
+    ring->slots[tail % RING_SLOTS] = item;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+// Next item, waiting for one unless `wait` is false (then NULL if empty;
+// *got tells an empty ring from a pushed NULL)
+void *ring_pop(SpscRing *ring, bool wait, bool *got) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    int spins = 0;
+    while (atomic_load_explicit(&ring->tail, memory_order_acquire) == head) {
+        if (!wait) {
+            *got = false;
+            return NULL;
+        }
+        ring_wait(&spins);
+    }
+    void *item = ring->slots[head % RING_SLOTS];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    *got = true;
+    return item;
+}
+
+typedef struct {
+    FILE *file;
+    SpscRing ring;
+} ReaderStage;
+
+// Reader: file blocks, filtered down to their digits
+void *reader_stage(void *arg) {
+    ReaderStage *stage = arg;
+    char buffer[PIPE_BLOCK_SIZE];
+    size_t got, total = 0;
+    while (total < MAX_CODE_SIZE - 1 && (got = fread(buffer, 1, sizeof(buffer), stage->file)) > 0) {
+        PipeBlock *block = malloc(sizeof(PipeBlock) + got);
+        if (!block) break;
+        block->length = 0;
+        for (size_t i = 0; i < got; i++) {
+            block->data[block->length] = buffer[i];
+            block->length += isdigit((unsigned char)buffer[i]) != 0;
+        }
+        total += block->length;
+        ring_push(&stage->ring, block);
+    }
+    ring_push(&stage->ring, NULL);
+    return NULL;
+}
+
+// Like load_numo_file(), decoding each digit as soon as the next one has
+// arrived. Loops jump both ways, so execution still starts once the whole
+// program is in.
+bool load_numo_pipelined(NumoInterpreter *interp, const char *filename) {
+    ReaderStage *stage = calloc(1, sizeof(ReaderStage));
+    if (!stage) return false;
+    stage->file = fopen(filename, "r");
+    if (!stage->file) {
+        fprintf(interp->out, RED "Error: Cannot open file %s\n" RESET, filename);
+        free(stage);
+        return false;
+    }
+    if (is_numc_file(stage->file)) { // Nothing to filter
+        fclose(stage->file);
+        free(stage);
+        return load_numo_file(interp, filename);
+    }
+    pthread_t reader;
+    if (pthread_create(&reader, NULL, reader_stage, stage) != 0) {
+        fclose(stage->file);
+        free(stage);
+        return load_numo_file(interp, filename);
+    }
+
+    int length = 0;
+    bool got;
+    PipeBlock *block;
+    while ((block = ring_pop(&stage->ring, true, &got)) != NULL) {
+        size_t take = block->length;
+        if (take > (size_t)(MAX_CODE_SIZE - 1 - length)) take = MAX_CODE_SIZE - 1 - length;
+        memcpy(interp->code + length, block->data, take);
+        free(block);
+        length += take;
+        interp->code_length = length;
+        for (int i = (length - (int)take > 0) ? length - (int)take - 1 : 0; i + 1 < length; i++) {
+            interp->program[i] = decode_instruction(interp, i);
+        }
+    }
+    pthread_join(reader, NULL);
+    fclose(stage->file);
+    free(stage);
+
+    interp->code[length] = '\0';
+    interp->code_length = length;
+    if (length > 0) interp->program[length - 1] = decode_instruction(interp, length - 1);
+    build_jump_table(interp);
+    analyze_segments(interp);
+    plan_resources(interp, &interp->plan);
+    size_variable_store(interp);
+
+    fprintf(interp->out, GREEN "Loaded Numo 0-9 program: %d digits\n" RESET, interp->code_length);
+    return true;
+}
+
+typedef struct {
+    SpscRing ring;
+    pthread_t thread;
+    bool threaded;
+    FILE *target;
+} WriterStage;
+
+// Writer: everything queued so far goes out in one writev
+void *writer_stage(void *arg) {
+    WriterStage *stage = arg;
+    PipeBlock *blocks[RING_SLOTS];
+    struct iovec iov[RING_SLOTS];
+    bool done = false;
+    while (!done) {
+        int count = 0;
+        bool got;
+        do {
+            PipeBlock *block = ring_pop(&stage->ring, count == 0, &got);
+            if (got && !block) done = true;
+            if (!block) break;
+            blocks[count] = block;
+            iov[count].iov_base = block->data;
+            iov[count++].iov_len = block->length;
+        } while (count < RING_SLOTS);
+        write_slices(fileno(stage->target), iov, count);
+        for (int i = 0; i < count; i++) free(blocks[i]);
+    }
+    return NULL;
+}
+
+ssize_t pipeline_output_write(void *cookie, const char *buf, size_t size) {
+    WriterStage *stage = cookie;
+    PipeBlock *block = malloc(sizeof(PipeBlock) + size);
+    if (!block) return 0;
+    block->length = size;
+    memcpy(block->data, buf, size);
+    if (stage->threaded) {
+        ring_push(&stage->ring, block);
+    } else {
+        fwrite(block->data, 1, size, stage->target);
+        free(block);
+    }
+    return size;
+}
+
+// Route interp->out through a writer thread; set up before any output
+// limit, which then writes into this stream
+bool open_output_pipeline(NumoInterpreter *interp, WriterStage *stage) {
+    memset(stage, 0, sizeof(*stage));
+    stage->target = interp->out;
+    fflush(stage->target);
+    cookie_io_functions_t io = { NULL, pipeline_output_write, NULL, NULL };
+    FILE *stream = fopencookie(stage, "w", io);
+    if (!stream) return false;
+    setvbuf(stream, NULL, _IOFBF, PIPE_BLOCK_SIZE);
+    stage->threaded = pthread_create(&stage->thread, NULL, writer_stage, stage) == 0;
+    interp->out = stream;
+    return true;
+}
+
+void close_output_pipeline(NumoInterpreter *interp, WriterStage *stage) {
+    fclose(interp->out);
+    interp->out = stage->target;
+    if (stage->threaded) {
+        ring_push(&stage->ring, NULL);
+        pthread_join(stage->thread, NULL);
+    }
+}
+
+// Header, folded prefix output and memo analysis, once per run
+void begin_run(NumoInterpreter *interp) {
+    clock_gettime(CLOCK_MONOTONIC, &interp->run_start);
+    print_run_header(interp);
+
+    if (interp->folded) {
+        fwrite(interp->fold_output, 1, interp->fold_output_len, interp->out);
+    }
+    interp->run_started = true;
+}
+
+// Summary (or limit report) once the run can go no further
+RunStatus end_run(NumoInterpreter *interp) {
+    interp->run_finished = true;
+    if (interp->limits_active && !within_limits(interp)) {
+        report_limit(interp);
+        return RUN_ERROR;
+    }
+
+    finish_run(interp);
+    if (interp->memo_enabled) {
+        fprintf(interp->out, BLUE "Memo cache: %d hits, %d misses\n" RESET, interp->memo_hits, interp->memo_misses);
+    }
+    if (interp->folded && interp->debug_mode) {
+        fprintf(interp->out, BLUE "Constant folding: %d of %d digits evaluated at load time\n" RESET,
+                interp->fold_position, interp->code_length);
+    }
+    return RUN_FINISHED;
+}
+
+// Resumable interpreter loop: run at most max_steps instructions (0 = no
+// budget; a memo segment runs only if it fits) and say why it stopped.
+// A waiting input op keeps the position, so the next call retries it.
+RunStatus numo_run_for(NumoInterpreter *interp, long max_steps) {
+    if (interp->run_finished) {
+        return interp->limit_hit != LIMIT_NONE ? RUN_ERROR : RUN_FINISHED;
+    }
+    if (!interp->run_started) {
+        begin_run(interp);
+    }
+
+    long budget_end = interp->instructions_executed + max_steps;
+    while (interp->position < interp->code_length) {
+        if (max_steps > 0 && interp->instructions_executed >= budget_end) return RUN_YIELDED;
+        if (interp->limits_active && !within_limits(interp)) break;
+        if (!input_ready(interp, interp->position)) return RUN_WAITING_INPUT;
+        bool fits = max_steps == 0 ||
+                    interp->segment_end[interp->position] - interp->position <= budget_end - interp->instructions_executed;
+        if (interp->memo_enabled && fits && run_memoized_segment(interp)) {
+            continue;
+        }
+        execute_step(interp);
+    }
+    return end_run(interp);
+}
+
+// Main interpreter loop
+void interpret(NumoInterpreter *interp) {
+    begin_run(interp);
+
+    // The JIT has no tracing, memo or limit hooks; those runs stay interpreted
+    if (interp->jit_enabled && !interp->debug_mode && !interp->memo_enabled && !interp->limits_active &&
+        (interp->jit_code || jit_compile(interp))) {
+        jit_run(interp);
+    }
+
+    numo_run_for(interp, 0);
+}
+
+// Drive the program through numo_run_for() in slices of `slice` steps,
+// feeding stdin one line at a time whenever an input op is waiting
+void run_sliced(NumoInterpreter *interp, long slice) {
+    int slices = 0;
+    int waits = 0;
+    char line[MAX_STRING_LEN];
+    interp->host_input = true;
+
+    RunStatus status;
+    while ((status = numo_run_for(interp, slice)) != RUN_FINISHED && status != RUN_ERROR) {
+        slices++;
+        if (status == RUN_WAITING_INPUT) {
+            waits++;
+            if (fgets(line, sizeof(line), stdin)) {
+                numo_provide_input(interp, line, strlen(line));
+            } else {
+                numo_close_input(interp);
             }
-            break;
-            
-        case 4: // DO-WHILE loop
-            printf(CYAN "DO-WHILE loop\n" RESET);
-            int j = 0;
-            do {
-                printf(YELLOW "  DO-WHILE iteration %d\n" RESET, j + 1);
-                j++;
-            } while (j < 2);
-            break;
-            
-        case 5: // REPEAT loop
-            if (interp->var_count > 0) {
-                Variable *var = &interp->vars[interp->var_count - 1];
-                int repeats = (var->type == 3) ? var->value.int_val : 3;
-                
-                printf(GREEN "REPEAT loop %d times\n" RESET, repeats);
-                for (int k = 0; k < repeats && k < 4; k++) {
-                    printf(MAGENTA "  REPEAT %d\n" RESET, k + 1);
+        }
+    }
+    if (interp->debug_mode) {
+        fprintf(interp->out, BLUE "Sliced run: %d yields, %d input waits\n" RESET, slices - waits, waits);
+    }
+}
+
+// Ahead-of-time C backend: one straight-line call per digit into the same
+// runtime helpers the interpreter uses, with all context decoded here.
+// The output builds against this file: cc -O2 -I<numo dir> prog.c -lm
+void emit_c_program(NumoInterpreter *interp, const char *source_name, FILE *out) {
+    bool is_target[MAX_CODE_SIZE + 1] = { false };
+    bool has_jumps = false;
+    for (int i = 0; i < interp->code_length; i++) {
+        int targets[2] = { 0, 0 };
+        int count = branch_targets(interp, i, targets);
+        for (int t = 0; t < count; t++) {
+            is_target[targets[t]] = true;
+        }
+        has_jumps = has_jumps || instruction_may_jump(interp, i);
+    }
+
+    fprintf(out, "/* Numo 0-9 program %s compiled by --emit-c */\n", source_name);
+    fprintf(out, "#define NUMO_EMBEDDED\n#include \"main.c\"\n\n");
+    fprintf(out, "static const char numo_code[] =\n    \"");
+    for (int i = 0; i < interp->code_length; i++) {
+        if (i > 0 && i % 64 == 0) fprintf(out, "\"\n    \"");
+        fputc(interp->code[i], out);
+    }
+    fprintf(out, "\";\n\n");
+
+    fprintf(out, "static void numo_program(NumoInterpreter *interp) {\n");
+    for (int i = 0; i < interp->code_length; i++) {
+        Instruction instr = interp->program[i];
+        bool may_jump = instruction_may_jump(interp, i);
+        if (is_target[i]) fprintf(out, "L_%d:\n", i);
+        if (may_jump) fprintf(out, "    interp->position = %d;\n", i);
+        switch (instr.op) {
+            case OP_BIT:
+                // Only the first digit of a straight run can open the payload
+                if (i == 0 || interp->program[i - 1].op != OP_BIT || is_target[i]) {
+                    fprintf(out, "    mark_binary(interp, %d);\n", i);
                 }
-            }
-            break;
-            
-        default:
-            printf(RED "End of binary program marker\n" RESET);
-            break;
+                break;
+            case OP_TWO: fprintf(out, "    end_binary_or_loop(interp, %d, %d);\n", instr.arg, i); break;
+            case OP_INT_VAR: fprintf(out, "    create_int_variable(interp, %d, %d);\n", i, instr.arg); break;
+            case OP_FLOAT_VAR: fprintf(out, "    create_float_variable(interp, %d);\n", i); break;
+            case OP_STRING_VAR: fprintf(out, "    create_string_variable(interp, %d);\n", i); break;
+            case OP_DISPLAY: fprintf(out, "    display_last_variable(interp);\n"); break;
+            case OP_BOOL_VAR: fprintf(out, "    create_bool_variable(interp, %d);\n", i); break;
+            case OP_CONTROL: fprintf(out, "    execution_control(interp);\n"); break;
+            case OP_CONDITIONAL: fprintf(out, "    handle_conditionals(interp, %d, %d);\n", instr.arg, i); break;
+            case OP_IO: fprintf(out, "    handle_enhanced_io(interp, %d, %d);\n", instr.arg, i); break;
+            case OP_MATH: fprintf(out, "    handle_math(interp, %d, %d);\n", instr.arg, i); break;
+            case OP_FILE: fprintf(out, "    handle_file_ops(interp, %d);\n", i); break;
+            case OP_ARRAY_VAR: fprintf(out, "    create_array_variable(interp, %d);\n", i); break;
+            case OP_DICT: fprintf(out, "    handle_dict_op(interp, %d, %d);\n", instr.arg, i); break;
+        }
+        if (may_jump) fprintf(out, "    if (interp->position != %d) goto dispatch;\n", i);
+    }
+    if (is_target[interp->code_length]) fprintf(out, "L_%d:\n", interp->code_length);
+    fprintf(out, "    interp->position = %d;\n", interp->code_length);
+
+    // Jumps land on the digit after the moved position
+    if (has_jumps) {
+        fprintf(out, "    return;\ndispatch:\n    switch (interp->position + 1) {\n");
+        for (int i = 0; i <= interp->code_length; i++) {
+            if (is_target[i]) fprintf(out, "        case %d: goto L_%d;\n", i, i);
+        }
+        fprintf(out, "    }\n");
     }
+    fprintf(out, "}\n\n");
+
+    fprintf(out, "int main(void) {\n");
+    fprintf(out, "    static NumoInterpreter interp;\n");
+    fprintf(out, "    init_interpreter(&interp);\n");
+    fprintf(out, "    strcpy(interp.code, numo_code);\n");
+    fprintf(out, "    interp.code_length = %d;\n", interp->code_length);
+    fprintf(out, "    interp.bignum_enabled = %s;\n", interp->bignum_enabled ? "true" : "false");
+    fprintf(out, "    interp.arrays_enabled = %s;\n", interp->arrays_enabled ? "true" : "false");
+    fprintf(out, "    interp.strings_enabled = %s;\n", interp->strings_enabled ? "true" : "false");
+    fprintf(out, "    interp.dicts_enabled = %s;\n", interp->dicts_enabled ? "true" : "false");
+    fprintf(out, "    interp.term_mode = %d;\n", interp->term_mode);
+    fprintf(out, "    compile_program(&interp);\n");
+    fprintf(out, "    fprintf(interp.out, GREEN \"Loaded Numo 0-9 program: %%d digits\\n\" RESET, interp.code_length);\n");
+    fprintf(out, "    print_run_header(&interp);\n");
+    fprintf(out, "    numo_program(&interp);\n");
+    fprintf(out, "    finish_run(&interp);\n");
+    fprintf(out, "    return 0;\n}\n");
 }
 
-// Enhanced variable creation (digit 3) - IMPROVED
-void handle_variable_creation(NumoInterpreter *interp, int position) {
-    int prev_digit = (position > 0) ? interp->code[position - 1] - '0' : 0;
-    int next_digit = (position + 1 < interp->code_length) ? interp->code[position + 1] - '0' : 0;
-    
-    if (interp->var_count >= MAX_VARIABLES) return;
-    
-    Variable *var = &interp->vars[interp->var_count];
-    
-    if (prev_digit == 6 || next_digit == 6) {
-        // Float variable
-        var->type = 6;
-        sprintf(var->name, "float_var_%d", position);
-        var->value.float_val = (double)(position % 100) / 10.0;
-        printf(GREEN "Created FLOAT variable %s = %.2f\n" RESET, var->name, var->value.float_val);
+double elapsed_ms(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+// Time repeated runs of the loaded program through the switch-based
+// interpret() loop and through the JIT, with program output discarded
+void run_benchmark(NumoInterpreter *interp, int runs) {
+    FILE *devnull = fopen("/dev/null", "w");
+    if (!devnull) return;
+    FILE *real_out = interp->out;
+    interp->out = devnull;
+    interp->debug_mode = false;
+    interp->memo_enabled = false;
+
+    double times[2];
+    for (int mode = 0; mode < 2; mode++) {
+        interp->jit_enabled = (mode == 1);
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int r = 0; r < runs; r++) {
+            reset_run_state(interp);
+            interpret(interp);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        times[mode] = elapsed_ms(start, end);
+    }
+    interp->out = real_out;
+    fclose(devnull);
+
+    printf(BOLD CYAN "Benchmark: %d runs of %d digits\n" RESET, runs, interp->code_length);
+    printf(YELLOW "Interpreter: %.3f ms/run\n" RESET, times[0] / runs);
+    if (interp->jit_code) {
+        printf(GREEN "JIT:         %.3f ms/run (%.2fx)\n" RESET, times[1] / runs,
+               times[1] > 0 ? times[0] / times[1] : 0.0);
     } else {
-        // Integer variable
-        var->type = 3;
-        sprintf(var->name, "int_var_%d", position);
-        var->value.int_val = next_digit;
-        printf(YELLOW "Created INTEGER variable %s = %d\n" RESET, var->name, var->value.int_val);
+        printf(RED "JIT unavailable on this architecture\n" RESET);
+    }
+}
+
+#ifndef NUMO_EMBEDDED
+// Work-stealing scheduler: many programs on a fixed pool of threads. Each
+// worker owns a deque; it takes tasks from the front and puts a task that
+// used up its slice back at the end, so long programs rotate with short
+// ones instead of starving them. Idle workers steal from the back of the
+// other deques. Programs see end of file on input and their output is
+// captured per task.
+typedef struct {
+    NumoInterpreter *interp;
+    FILE *capture;
+    char *output;
+    size_t output_len;
+    RunStatus status;
+    LimitKind limit_hit;
+    bool loaded;
+} NumoTask;
+
+typedef struct {
+    NumoTask **items;
+    int capacity;
+    int head;
+    int count;
+    pthread_mutex_t lock;
+} TaskDeque;
+
+// Workers that find every deque empty sleep on work_ready until a task is
+// queued or the last one finishes, instead of spinning
+typedef struct {
+    TaskDeque *deques;
+    int worker_count;
+    long slice;
+    atomic_int remaining;
+    atomic_int queued;          // tasks sitting in the deques
+    pthread_mutex_t idle_lock;
+    pthread_cond_t work_ready;
+} Scheduler;
+
+typedef struct {
+    Scheduler *scheduler;
+    int id;
+} WorkerArgs;
+
+void deque_push_back(TaskDeque *deque, NumoTask *task) {
+    pthread_mutex_lock(&deque->lock);
+    deque->items[(deque->head + deque->count) % deque->capacity] = task;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+// Queue a task and wake one idle worker to take or steal it
+void schedule_task(Scheduler *scheduler, TaskDeque *deque, NumoTask *task) {
+    deque_push_back(deque, task);
+    atomic_fetch_add(&scheduler->queued, 1);
+    pthread_mutex_lock(&scheduler->idle_lock);
+    pthread_cond_signal(&scheduler->work_ready);
+    pthread_mutex_unlock(&scheduler->idle_lock);
+}
+
+NumoTask *deque_pop_front(TaskDeque *deque) {
+    NumoTask *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0) {
+        task = deque->items[deque->head];
+        deque->head = (deque->head + 1) % deque->capacity;
+        deque->count--;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+NumoTask *deque_pop_back(TaskDeque *deque) {
+    NumoTask *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0) {
+        deque->count--;
+        task = deque->items[(deque->head + deque->count) % deque->capacity];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+// Load a program into its own interpreter with the CLI's settings
+NumoTask *create_task(const char *filename, const NumoInterpreter *config) {
+    NumoTask *task = calloc(1, sizeof(NumoTask));
+    if (!task) return NULL;
+    task->interp = calloc(1, sizeof(NumoInterpreter));
+    task->capture = open_memstream(&task->output, &task->output_len);
+    if (!task->interp || !task->capture) {
+        if (task->capture) fclose(task->capture);
+        free(task->output);
+        free(task->interp);
+        free(task);
+        return NULL;
+    }
+
+    NumoInterpreter *interp = task->interp;
+    init_interpreter(interp);
+    interp->out = task->capture;
+    interp->debug_mode = config->debug_mode;
+    interp->memo_enabled = config->memo_enabled;
+    interp->bignum_enabled = config->bignum_enabled;
+    interp->arrays_enabled = config->arrays_enabled;
+    interp->strings_enabled = config->strings_enabled;
+    interp->dicts_enabled = config->dicts_enabled;
+    interp->cache_dir = config->cache_dir;
+    interp->shm_cache = config->shm_cache;
+    interp->term_mode = config->term_mode;
+    interp->limits = config->limits;
+    interp->limits_active = config->limits_active;
+    interp->host_input = true;
+    if (config->host_input) { // --input: every program reads the same file
+        numo_provide_input(interp, config->input_data, config->input_len);
+        interp->input_tty = false;
     }
-    
-    interp->var_count++;
+    numo_close_input(interp);
+
+    if (interp->limits.max_output_bytes > 0 && !open_output_limit(interp)) {
+        return task;
+    }
+    task->loaded = load_numo_file(interp, filename);
+    return task;
 }
 
-// Enhanced string handling (digit 4) - IMPROVED
-void handle_string_operations(NumoInterpreter *interp, int position) {
-    int prev_digit = (position > 0) ? interp->code[position - 1] - '0' : 0;
-    int next_digit = (position + 1 < interp->code_length) ? interp->code[position + 1] - '0' : 0;
-    
-    if (next_digit == 7 || prev_digit == 7) {
-        // Display/output mode
-        if (interp->var_count > 0) {
-            Variable *var = &interp->vars[interp->var_count - 1];
-            printf(BOLD CYAN "=== STRING OUTPUT ===" RESET "\n");
-            
-            switch (var->type) {
-                case 3:
-                    printf(GREEN "Number: %d\n" RESET, var->value.int_val);
-                    break;
-                case 4:
-                    printf(MAGENTA "Text: \"%s\"\n" RESET, var->value.str_val);
-                    break;
-                case 5:
-                    printf(BLUE "Boolean: %s\n" RESET, var->value.bool_val ? "TRUE" : "FALSE");
-                    break;
-                case 6:
-                    printf(YELLOW "Float: %.2f\n" RESET, var->value.float_val);
-                    break;
-                default:
-                    printf(WHITE "Unknown variable type\n" RESET);
-                    break;
+// Release the interpreter once the task is done; the output stays
+void finish_task(NumoTask *task) {
+    NumoInterpreter *interp = task->interp;
+    task->limit_hit = interp->limit_hit;
+    close_output_limit(interp);
+    fclose(task->capture);
+    task->capture = NULL;
+    free_memo_table(interp);
+    free_bignums(interp);
+    free_arrays(interp);
+    free_string_arena(interp);
+    free_dicts(interp);
+    detach_shared_code(interp);
+    free(interp->vars);
+    free(interp->input_data);
+    free(interp);
+    task->interp = NULL;
+}
+
+void free_task(NumoTask *task) {
+    if (task->interp) finish_task(task);
+    free(task->output);
+    free(task);
+}
+
+void *scheduler_worker(void *arg) {
+    WorkerArgs *args = arg;
+    Scheduler *scheduler = args->scheduler;
+    TaskDeque *own = &scheduler->deques[args->id];
+
+    while (atomic_load(&scheduler->remaining) > 0) {
+        NumoTask *task = deque_pop_front(own);
+        for (int i = 1; !task && i < scheduler->worker_count; i++) {
+            task = deque_pop_back(&scheduler->deques[(args->id + i) % scheduler->worker_count]);
+        }
+        if (!task) {
+            pthread_mutex_lock(&scheduler->idle_lock);
+            while (atomic_load(&scheduler->queued) <= 0 && atomic_load(&scheduler->remaining) > 0) {
+                pthread_cond_wait(&scheduler->work_ready, &scheduler->idle_lock);
             }
-            printf(BOLD CYAN "===================" RESET "\n");
-        } else {
-            printf(RED "No variables to display!\n" RESET);
+            pthread_mutex_unlock(&scheduler->idle_lock);
+            continue;
         }
-    } else {
-        // Create string variable
-        if (interp->var_count < MAX_VARIABLES) {
-            Variable *var = &interp->vars[interp->var_count];
-            var->type = 4;
-            sprintf(var->name, "string_var_%d", position);
-            sprintf(var->value.str_val, "Hello_%d", position);
-            printf(MAGENTA "Created STRING variable %s = \"%s\"\n" RESET, var->name, var->value.str_val);
-            interp->var_count++;
+        atomic_fetch_sub(&scheduler->queued, 1);
+
+        task->status = numo_run_for(task->interp, scheduler->slice);
+        if (task->status == RUN_YIELDED) {
+            schedule_task(scheduler, own, task);
+            continue;
+        }
+        finish_task(task);
+        if (atomic_fetch_sub(&scheduler->remaining, 1) == 1) {
+            pthread_mutex_lock(&scheduler->idle_lock);
+            pthread_cond_broadcast(&scheduler->work_ready);
+            pthread_mutex_unlock(&scheduler->idle_lock);
         }
     }
+    return NULL;
 }
 
-// Enhanced boolean and execution control (digit 5) - IMPROVED
-void handle_boolean_and_control(NumoInterpreter *interp, int position) {
-    int prev_digit = (position > 0) ? interp->code[position - 1] - '0' : 0;
-    int next_digit = (position + 1 < interp->code_length) ? interp->code[position + 1] - '0' : 0;
-    
-    if (prev_digit == 6 || next_digit == 6) {
-        // Execution control mode
-        if (interp->var_count > 0) {
-            Variable *var = &interp->vars[interp->var_count - 1];
-            bool condition = false;
-            
-            switch (var->type) {
-                case 3: condition = (var->value.int_val > 0); break;
-                case 5: condition = var->value.bool_val; break;
-                case 6: condition = (var->value.float_val > 0.0); break;
-                default: condition = true; break;
-            }
-            
-            if (condition) {
-                printf(GREEN "EXECUTION CONTROL: Condition TRUE - Continue program\n" RESET);
-                // Continue normal execution
-            } else {
-                printf(RED "EXECUTION CONTROL: Condition FALSE - Skip next operation\n" RESET);
-                // Skip next position
-                if (interp->position + 1 < interp->code_length) {
-                    interp->position++;
-                }
-            }
+// Run the loaded tasks to completion on `workers` threads, `slice`
+// instructions at a time
+bool run_scheduler(NumoTask **tasks, int task_count, int workers, long slice) {
+    Scheduler scheduler;
+    scheduler.worker_count = workers;
+    scheduler.slice = slice;
+    scheduler.deques = calloc(workers, sizeof(TaskDeque));
+    pthread_t *threads = calloc(workers, sizeof(pthread_t));
+    WorkerArgs *args = calloc(workers, sizeof(WorkerArgs));
+    if (!scheduler.deques || !threads || !args) {
+        free(scheduler.deques);
+        free(threads);
+        free(args);
+        return false;
+    }
+    atomic_init(&scheduler.queued, 0);
+    pthread_mutex_init(&scheduler.idle_lock, NULL);
+    pthread_cond_init(&scheduler.work_ready, NULL);
+
+    bool ok = true;
+    for (int w = 0; w < workers; w++) {
+        TaskDeque *deque = &scheduler.deques[w];
+        deque->capacity = task_count > 0 ? task_count : 1;
+        deque->items = calloc(deque->capacity, sizeof(NumoTask *));
+        if (!deque->items) ok = false;
+        pthread_mutex_init(&deque->lock, NULL);
+    }
+
+    int queued = 0;
+    for (int i = 0; ok && i < task_count; i++) {
+        if (tasks[i]->loaded) {
+            schedule_task(&scheduler, &scheduler.deques[queued++ % workers], tasks[i]);
         }
-    } else {
-        // Create boolean variable
-        if (interp->var_count < MAX_VARIABLES) {
-            Variable *var = &interp->vars[interp->var_count];
-            var->type = 5;
-            sprintf(var->name, "bool_var_%d", position);
-            var->value.bool_val = (position % 2 == 0);
-            printf(BLUE "Created BOOLEAN variable %s = %s\n" RESET, var->name, 
-                   var->value.bool_val ? "TRUE" : "FALSE");
-            interp->var_count++;
+    }
+    atomic_init(&scheduler.remaining, ok ? queued : 0);
+
+    int started = 0;
+    for (; ok && started < workers; started++) {
+        args[started].scheduler = &scheduler;
+        args[started].id = started;
+        if (pthread_create(&threads[started], NULL, scheduler_worker, &args[started]) != 0) break;
+    }
+    if (ok && started == 0) {
+        scheduler_worker(&(WorkerArgs){ &scheduler, 0 });
+    }
+    for (int w = 0; w < started; w++) {
+        pthread_join(threads[w], NULL);
+    }
+
+    for (int w = 0; w < workers; w++) {
+        free(scheduler.deques[w].items);
+        pthread_mutex_destroy(&scheduler.deques[w].lock);
+    }
+    pthread_mutex_destroy(&scheduler.idle_lock);
+    pthread_cond_destroy(&scheduler.work_ready);
+    free(scheduler.deques);
+    free(threads);
+    free(args);
+    return ok;
+}
+
+// Run every file through the scheduler and print the outputs in order
+int run_batch(const char **files, int file_count, const NumoInterpreter *config, int workers, long slice) {
+    NumoTask **tasks = calloc(file_count, sizeof(NumoTask *));
+    if (!tasks) return 1;
+    for (int i = 0; i < file_count; i++) {
+        tasks[i] = create_task(files[i], config);
+        if (!tasks[i]) {
+            printf(RED "Error: Cannot create task for '%s'\n" RESET, files[i]);
+            file_count = i;
+            break;
+        }
+    }
+
+    run_scheduler(tasks, file_count, workers, slice);
+
+    int exit_code = 0;
+    for (int i = 0; i < file_count; i++) {
+        if (tasks[i]->interp) finish_task(tasks[i]);
+        printf(BOLD CYAN "=== %s ===\n" RESET, files[i]);
+        fwrite(tasks[i]->output, 1, tasks[i]->output_len, stdout);
+        if (exit_code == 0) {
+            exit_code = limit_exit_code(tasks[i]->limit_hit);
         }
+        free_task(tasks[i]);
     }
+    free(tasks);
+    return exit_code;
 }
 
-// Enhanced input/output operations
-void handle_enhanced_io(NumoInterpreter *interp, int io_type, int position) {
-    printf(BLUE "Enhanced I/O operation type %d at position %d\n" RESET, io_type, position);
+// Throughput of `count` copies of one program: the scheduler with N
+// threads against N concurrent processes running one program each
+void run_scheduler_benchmark(const char *filename, int count, const NumoInterpreter *config) {
+    static const int thread_counts[] = { 1, 4, 16, 64 };
+    printf(BOLD CYAN "Scheduler benchmark: %d copies of %s\n" RESET, count, filename);
+    printf(YELLOW "%8s %18s %18s\n" RESET, "Threads", "Scheduler prog/s", "Processes prog/s");
 
-    switch (io_type) {
-        case 0: // Input number
-            printf(YELLOW "Enter a number: " RESET);
-            fflush(stdout);
-            int input_val;
-            if (scanf("%d", &input_val) == 1) {
-                // Clear input buffer
-                while (getchar() != '\n');
-                if (interp->var_count < MAX_VARIABLES) {
-                    Variable *var = &interp->vars[interp->var_count];
-                    var->type = 3;
-                    sprintf(var->name, "input_num_%d", position);
-                    var->value.int_val = input_val;
-                    printf(GREEN "Stored input %d in variable %s\n" RESET, input_val, var->name);
-                    interp->var_count++;
-                }
-            } else {
-                printf(RED "Invalid input!\n" RESET);
-                // Clear input buffer
-                while (getchar() != '\n');
-            }
-            break;
-        case 1: // Input string
-            printf(YELLOW "Enter a string: " RESET);
-            fflush(stdout);
-            char input_str[MAX_STRING_LEN];
-            if (fgets(input_str, sizeof(input_str), stdin)) {
-                // Remove newline if present
-                input_str[strcspn(input_str, "\n")] = 0;
-                if (interp->var_count < MAX_VARIABLES) {
-                    Variable *var = &interp->vars[interp->var_count];
-                    var->type = 4;
-                    sprintf(var->name, "input_str_%d", position);
-                    strcpy(var->value.str_val, input_str);
-                    printf(GREEN "Stored input \"%s\" in variable %s\n" RESET, input_str, var->name);
-                    interp->var_count++;
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+        int workers = thread_counts[t];
+        struct timespec start, end;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        NumoTask **tasks = calloc(count, sizeof(NumoTask *));
+        int created = 0;
+        while (tasks && created < count && (tasks[created] = create_task(filename, config))) {
+            created++;
+        }
+        if (tasks) run_scheduler(tasks, created, workers, 1000);
+        for (int i = 0; i < created; i++) {
+            free_task(tasks[i]);
+        }
+        free(tasks);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double scheduler_ms = elapsed_ms(start, end);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int launched = 0;
+        int running = 0;
+        while (launched < count || running > 0) {
+            if (launched < count && running < workers) {
+                pid_t pid = fork();
+                if (pid == 0) {
+                    int devnull = open("/dev/null", O_RDWR);
+                    dup2(devnull, STDIN_FILENO);
+                    dup2(devnull, STDOUT_FILENO);
+                    dup2(devnull, STDERR_FILENO);
+                    execl("/proc/self/exe", "main", filename, (char *)NULL);
+                    _exit(127);
                 }
+                if (pid > 0) running++;
+                launched++;
+            } else if (wait(NULL) > 0) {
+                running--;
             } else {
-                printf(RED "Error reading string input!\n" RESET);
-            }
-            break;
-        case 2: // Display variable
-            if (interp->var_count > 0) {
-                Variable *var = &interp->vars[interp->var_count - 1];
-                printf(CYAN "Display variable %s: " RESET, var->name);
-                switch (var->type) {
-                    case 3: printf("%d\n", var->value.int_val); break;
-                    case 4: printf("\"%s\"\n", var->value.str_val); break;
-                    case 5: printf("%s\n", var->value.bool_val ? "true" : "false"); break;
-                    case 6: printf("%.2f\n", var->value.float_val); break;
-                }
-            }
-            break;
-        case 3: // Clear screen
-            system("clear");
-            printf(GREEN "Screen cleared\n" RESET);
-            break;
-        case 4: // Pause/Wait
-            printf(YELLOW "Press Enter to continue..." RESET);
-            getchar();
-            break;
-        case 5: // Random number
-            if (interp->var_count < MAX_VARIABLES) {
-                Variable *var = &interp->vars[interp->var_count];
-                var->type = 3;
-                sprintf(var->name, "random_%d", position);
-                var->value.int_val = rand() % 100;
-                printf(GREEN "Generated random number %d\n" RESET, var->value.int_val);
-                interp->var_count++;
-            }
-            break;
-        case 6: // Print with color
-            set_color(interp, position % 10);
-            printf("%sColored output at position %d\n" RESET, interp->current_color, position);
-            break;
-        case 7: // Formatted output
-            printf(BOLD "=== Formatted Output ===" RESET "\n");
-            printf(CYAN "Position: %d\n" RESET, position);
-            printf(YELLOW "Variables: %d\n" RESET, interp->var_count);
-            break;
-        case 8: // Sound/Bell
-            printf("\a"); // Bell sound
-            printf(MAGENTA "Sound alert at position %d\n" RESET, position);
-            break;
-        case 9: // Time/Date
-            {
-                time_t now = time(NULL);
-                printf(GREEN "Current time: %s" RESET, ctime(&now));
+                break;
             }
-            break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double process_ms = elapsed_ms(start, end);
+
+        printf("%8d %18.1f %18.1f\n", workers,
+               scheduler_ms > 0 ? created * 1000.0 / scheduler_ms : 0.0,
+               process_ms > 0 ? count * 1000.0 / process_ms : 0.0);
     }
 }
+#endif
 
-// Handle math operations (digit 8) - FIXED
-void handle_math(NumoInterpreter *interp, int position) {
-    // The operation type is determined by the previous digit
-    int operation = 0; // Default to addition
-    if (position > 0) {
-        operation = interp->code[position - 1] - '0';
-        if (operation < 0 || operation > 9) operation = 0;
-    }
+// 10k-digit results: 3^20959 by squaring, its square by Karatsuba and by
+// schoolbook multiplication, and decimal conversion
+void run_bignum_benchmark() {
+    struct timespec start, end;
+    BigNum *three = big_from_int(3);
 
-    printf(MAGENTA "Math operation %d at position %d\n" RESET, operation, position);
-    handle_advanced_math(interp, operation, position);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    BigNum *power = big_pow(three, 20959);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double pow_ms = elapsed_ms(start, end);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    BigNum *square = big_mul(power, power);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double karatsuba_ms = elapsed_ms(start, end);
+
+    BigNum *school = big_new(power->len * 2);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    mag_mul_school(power->limbs, power->len, power->limbs, power->len, school->limbs);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double school_ms = elapsed_ms(start, end);
+    school->sign = 1;
+    big_normalize(school);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    char *text = big_to_string(square);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double print_ms = elapsed_ms(start, end);
+
+    char *power_text = big_to_string(power);
+    printf(BOLD CYAN "Bignum benchmark\n" RESET);
+    printf(YELLOW "3^20959:              %8.3f ms (%zu digits)\n" RESET, pow_ms, strlen(power_text));
+    printf(GREEN "Square (Karatsuba):   %8.3f ms (%zu digits)\n" RESET, karatsuba_ms, strlen(text));
+    printf(GREEN "Square (schoolbook):  %8.3f ms (%.2fx)%s\n" RESET, school_ms,
+           karatsuba_ms > 0 ? school_ms / karatsuba_ms : 0.0,
+           mag_compare(square->limbs, square->len, school->limbs, school->len) == 0 ? "" : " MISMATCH");
+    printf(BLUE "Decimal conversion:   %8.3f ms\n" RESET, print_ms);
+
+    free(power_text);
+    free(text);
+    free(school);
+    free(square);
+    free(power);
+    free(three);
 }
 
-// Handle file operations (digit 9)
-void handle_file_ops(NumoInterpreter *interp, int position) {
-    printf(CYAN "Advanced file operation at position %d\n" RESET, position);
+// Elementwise kernels on two N-element arrays: GB/s through array_apply()
+// (vector kernels, threads when large) against a plain scalar loop, then
+// reductions against a scalar loop and sorts against qsort
+void run_array_benchmark(long length) {
+    static const int operations[] = { 0, 1, 2, 3, 9, 5 };
+    static const char *names[] = { "add", "sub", "mul", "div", "mod", "sqrt" };
+    if (length <= 0 || length > ARRAY_MAX_LENGTH) length = 1 << 22;
+    NumoInterpreter *interp = calloc(1, sizeof(NumoInterpreter));
+    if (!interp) return;
+    interp->out = stdout;
+    NumArray *left = new_array(interp, length);
+    NumArray *right = new_array(interp, length);
+    NumArray *out = new_array(interp, length);
+    if (!left || !right || !out) {
+        free_arrays(interp);
+        free(interp);
+        return;
+    }
+    for (long i = 0; i < length; i++) {
+        left->data[i] = (double)(i % 1000);
+        right->data[i] = (double)(i % 7 + 1);
+    }
 
-    char filename[50];
-    sprintf(filename, "numo_output_%d.txt", position);
+    printf(BOLD CYAN "Array benchmark: %ld elements, up to %d threads\n" RESET, length, ARRAY_MAX_THREADS);
+    for (size_t k = 0; k < sizeof(operations) / sizeof(operations[0]); k++) {
+        struct timespec start, end;
+        ArrayJob job = { operations[k], left->data, false, right->data, false, out->data, 0, (size_t)length };
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        array_apply(job);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double vector_ms = elapsed_ms(start, end);
 
-    FILE *file = fopen(filename, "w");
-    if (file) {
-        fprintf(file, "=== Numo 0-9 Advanced Output Report ===\n");
-        fprintf(file, "Position: %d\n", position);
-        fprintf(file, "Variables created: %d\n", interp->var_count);
-        fprintf(file, "Stack pointer: %d\n", interp->stack_pointer);
-        fprintf(file, "Loop depth: %d\n", interp->loop_depth);
-        fprintf(file, "\n--- Variables ---\n");
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long i = 0; i < length; i++) {
+            out->data[i] = scalar_math(operations[k], left->data[i], right->data[i]);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double scalar_ms = elapsed_ms(start, end);
 
-        for (int i = 0; i < interp->var_count; i++) {
-            Variable *var = &interp->vars[i];
-            switch (var->type) {
-                case 3:
-                    fprintf(file, "%s (int) = %d\n", var->name, var->value.int_val);
-                    break;
-                case 4:
-                    fprintf(file, "%s (string) = \"%s\"\n", var->name, var->value.str_val);
-                    break;
-                case 5:
-                    fprintf(file, "%s (bool) = %s\n", var->name, 
-                           var->value.bool_val ? "true" : "false");
-                    break;
-                case 6:
-                    fprintf(file, "%s (float) = %.2f\n", var->name, var->value.float_val);
-                    break;
-                case 7:
-                    fprintf(file, "%s (array) = [", var->name);
-                    for (int j = 0; j < var->array_size; j++) {
-                        fprintf(file, "%d%s", var->value.array_val[j], 
-                               (j < var->array_size - 1) ? ", " : "");
-                    }
-                    fprintf(file, "]\n");
-                    break;
-            }
+        double bytes = 3.0 * sizeof(double) * length;
+        printf(YELLOW "%-5s" RESET " engine %8.3f ms (%6.2f GB/s)   scalar %8.3f ms (%.2fx)\n", names[k],
+               vector_ms, vector_ms > 0 ? bytes / vector_ms / 1e6 : 0.0, scalar_ms,
+               vector_ms > 0 ? scalar_ms / vector_ms : 0.0);
+    }
+
+    static const ReduceKind kinds[] = { REDUCE_SUM, REDUCE_MIN, REDUCE_DOT };
+    static const char *reduce_names[] = { "sum", "min", "dot" };
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        volatile double result = array_reduce(kinds[k], left->data, right->data, length);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double engine_ms = elapsed_ms(start, end);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        double total = reduce_identity(kinds[k]);
+        for (long i = 0; i < length; i++) {
+            total = reduce_pair(kinds[k], total, kinds[k] == REDUCE_DOT ? left->data[i] * right->data[i] : left->data[i]);
         }
+        result = total;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double scalar_ms = elapsed_ms(start, end);
+        (void)result;
+        printf(YELLOW "%-5s" RESET " engine %8.3f ms   scalar %8.3f ms (%.2fx)\n", reduce_names[k], engine_ms,
+               scalar_ms, engine_ms > 0 ? scalar_ms / engine_ms : 0.0);
+    }
 
-        fprintf(file, "\n--- Execution Statistics ---\n");
-        fprintf(file, "Total code length: %d\n", interp->code_length);
-        fprintf(file, "Debug mode: %s\n", interp->debug_mode ? "enabled" : "disabled");
+    // Sorts: integers (radix) and fractions (merge), each against qsort
+    for (int fractional = 0; fractional < 2; fractional++) {
+        for (long i = 0; i < length; i++) {
+            left->data[i] = (double)((i * 2654435761u) % 1000003) / (fractional ? 7.0 : 1.0);
+        }
+        memcpy(out->data, left->data, length * sizeof(double));
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        const char *method = sort_array(left);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double engine_ms = elapsed_ms(start, end);
 
-        fclose(file);
-        printf(GREEN "Created advanced report: %s\n" RESET, filename);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        qsort(out->data, length, sizeof(double), compare_doubles);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double qsort_ms = elapsed_ms(start, end);
+        printf(YELLOW "%-5s" RESET " engine %8.3f ms   qsort  %8.3f ms (%.2fx)\n", method, engine_ms,
+               qsort_ms, engine_ms > 0 ? qsort_ms / engine_ms : 0.0);
     }
+    free_arrays(interp);
+    free(interp);
 }
 
-// Main interpreter loop
-void interpret(NumoInterpreter *interp) {
-    printf(BOLD GREEN "Starting Numo 0-9 Advanced Interpretation...\n" RESET);
-    printf(CYAN "Code length: %d characters\n" RESET, interp->code_length);
-    if (interp->debug_mode) {
-        printf(CYAN "Code: %s\n" RESET, interp->code);
+size_t naive_search(const char *hay, size_t hay_len, const char *needle, size_t needle_len) {
+    for (size_t i = 0; i + needle_len <= hay_len; i++) {
+        size_t k = 0;
+        while (k < needle_len && hay[i + k] == needle[k]) k++;
+        if (k == needle_len) return i;
     }
-    printf(YELLOW "==================================================\n" RESET);
+    return NOT_FOUND;
+}
 
-    int binary_start = -1;
+// String ops on an N MB text of words: search (needle absent, so the
+// whole text is scanned) against a naive loop and memmem, then case
+// conversion, replace and split against byte-at-a-time loops
+void run_string_benchmark(long megabytes) {
+    if (megabytes <= 0 || megabytes > 1024) megabytes = 16;
+    size_t length = (size_t)megabytes << 20;
+    char *text = malloc(length + 1);
+    char *copy = malloc(length + 1);
+    if (!text || !copy) {
+        free(text);
+        free(copy);
+        return;
+    }
+    srand(12345);
+    for (size_t i = 0; i < length; i++) {
+        text[i] = (rand() % 6 == 0) ? ' ' : 'a' + rand() % 26;
+    }
+    text[length] = '\0';
+    char long_needle[65];
+    for (int i = 0; i < 64; i++) long_needle[i] = 'a' + i % 26;
+    long_needle[64] = '\0';
+    const char *needles[] = { "numoxq", long_needle };
+    const char *names[] = { "search-6", "search-64" };
 
-    while (interp->position < interp->code_length) {
-        char current = interp->code[interp->position];
+    printf(BOLD CYAN "String benchmark: %ld MB\n" RESET, megabytes);
+    struct timespec start, end;
+    for (int n = 0; n < 2; n++) {
+        size_t needle_len = strlen(needles[n]);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        volatile size_t found = find_substring(text, length, needles[n], needle_len, 0);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double engine_ms = elapsed_ms(start, end);
 
-        if (interp->debug_mode) {
-            printf(MAGENTA "Position %d: Processing digit '%c'\n" RESET, interp->position, current);
-        }
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        found = naive_search(text, length, needles[n], needle_len);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double naive_ms = elapsed_ms(start, end);
 
-        switch (current) {
-            case '0':
-            case '1':
-                if (binary_start == -1) {
-                    binary_start = interp->position;
-                }
-                break;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        found = (size_t)memmem(text, length, needles[n], needle_len);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double memmem_ms = elapsed_ms(start, end);
+        (void)found;
+        printf(YELLOW "%-9s" RESET " engine %8.3f ms (%6.2f GB/s)   naive %8.3f ms   memmem %8.3f ms\n", names[n],
+               engine_ms, engine_ms > 0 ? length / engine_ms / 1e6 : 0.0, naive_ms, memmem_ms);
+    }
 
-            case '2': // End of binary program OR loops/iterations
-                if (binary_start != -1) {
-                    execute_binary(interp, binary_start, interp->position);
-                    binary_start = -1;
-                } else {
-                    handle_loops(interp, interp->position);
-                }
-                break;
+    memcpy(copy, text, length);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    convert_case(copy, length, true);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double engine_ms = elapsed_ms(start, end);
+    memcpy(copy, text, length);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < length; i++) copy[i] = toupper((unsigned char)copy[i]);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf(YELLOW "%-9s" RESET " engine %8.3f ms (%6.2f GB/s)   toupper %8.3f ms\n", "upper", engine_ms,
+           engine_ms > 0 ? length / engine_ms / 1e6 : 0.0, elapsed_ms(start, end));
 
-            case '3': // Enhanced variable creation (integers/floats)
-                handle_variable_creation(interp, interp->position);
-                break;
+    size_t result_len, count;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    char *replaced = replace_all(text, length, "ab", 2, "XYZ", 3, &result_len, &count);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf(YELLOW "%-9s" RESET " engine %8.3f ms   %zu occurrences of \"ab\"\n", "replace", elapsed_ms(start, end), count);
+    free(replaced);
 
-            case '4': // Enhanced string operations (create/display)
-                handle_string_operations(interp, interp->position);
-                break;
+    size_t pieces = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t from = 0;; pieces++) {
+        size_t match = find_substring(text, length, " ", 1, from);
+        if (match == NOT_FOUND) break;
+        from = match + 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    engine_ms = elapsed_ms(start, end);
+    size_t scalar_pieces = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < length; i++) scalar_pieces += (text[i] == ' ');
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf(YELLOW "%-9s" RESET " engine %8.3f ms   byte loop %8.3f ms   %zu pieces\n", "split", engine_ms,
+           elapsed_ms(start, end), pieces + 1);
+    free(text);
+    free(copy);
+}
 
-            case '5': // Enhanced boolean and execution control
-                handle_boolean_and_control(interp, interp->position);
-                break;
+// Dictionary throughput at N keys, int and string: inserts into an empty
+// table (growing as it goes), hit and miss lookups, then deletes. String
+// keys are leaves built up front, so interning is not timed.
+void run_dict_benchmark(long count) {
+    if (count <= 0 || count > DICT_MAX_ENTRIES) count = 1000000;
+    NumoInterpreter *interp = calloc(1, sizeof(NumoInterpreter));
+    DictKey *keys = malloc(2 * count * sizeof(DictKey));
+    uint64_t *hashes = malloc(2 * count * sizeof(uint64_t));
+    if (!interp || !keys || !hashes) {
+        free(interp);
+        free(keys);
+        free(hashes);
+        return;
+    }
+    interp->out = stdout;
 
-            case '6': // Conditionals (if, else, while, for, switch)
-                handle_conditionals(interp, interp->position);
+    printf(BOLD CYAN "Dictionary benchmark: %ld keys\n" RESET, count);
+    static const char *names[] = { "int", "string" };
+    struct timespec start, end;
+    for (int kind = 0; kind < 2; kind++) {
+        // Keys [0, count) are inserted, [count, 2 count) only looked up
+        bool built = true;
+        for (long i = 0; i < 2 * count; i++) {
+            long long value = (long long)mix64((uint64_t)i);
+            if (kind == 0) {
+                keys[i].int_key = value;
+                hashes[i] = mix64((uint64_t)value);
+                continue;
+            }
+            char text[32];
+            size_t length = snprintf(text, sizeof(text), "key-%lld", value);
+            Rope *leaf = arena_alloc(interp, sizeof(Rope) + length + 1);
+            if (!leaf) {
+                built = false;
                 break;
+            }
+            leaf->length = length;
+            leaf->height = 0;
+            leaf->left = leaf->right = leaf->next_interned = NULL;
+            leaf->hash = hash_bytes(FNV_OFFSET, text, length);
+            memcpy(leaf->text, text, length + 1);
+            keys[i].str_key = leaf;
+            hashes[i] = mix64(leaf->hash);
+        }
+        NumDict *dict = built ? new_dict(interp) : NULL;
+        if (!dict) break;
+        int key_type = kind == 0 ? 3 : 4;
 
-            case '7': // Enhanced Input/Output operations
-                handle_enhanced_io(interp, interp->position % 10, interp->position);
-                break;
+        double ms[4];
+        size_t hits = 0, misses = 0, index;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long i = 0; i < count; i++) {
+            DictSlot *slot = dict_insert(dict, hashes[i], key_type, keys[i]);
+            if (!slot) break;
+            slot->value_type = 3;
+            slot->value.int_val = i;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ms[0] = elapsed_ms(start, end);
 
-            case '8': // Mathematical operations
-                handle_math(interp, interp->position);
-                break;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long i = 0; i < count; i++) hits += dict_find(dict, hashes[i], key_type, keys[i], &index);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ms[1] = elapsed_ms(start, end);
 
-            case '9': // File operations
-                handle_file_ops(interp, interp->position);
-                break;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long i = count; i < 2 * count; i++) misses += !dict_find(dict, hashes[i], key_type, keys[i], &index);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ms[2] = elapsed_ms(start, end);
+        size_t capacity = dict->capacity;
 
-            default:
-                printf(RED "Unknown digit: %c at position %d\n" RESET, current, interp->position);
-                break;
-        }
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (long i = 0; i < count; i++) dict_delete(dict, hashes[i], key_type, keys[i]);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        ms[3] = elapsed_ms(start, end);
 
-        interp->position++;
+        printf(YELLOW "%-6s" RESET " insert %7.2f Mops/s   hit %7.2f Mops/s   miss %7.2f Mops/s   delete %7.2f Mops/s\n",
+               names[kind], ms[0] > 0 ? count / ms[0] / 1e3 : 0.0, ms[1] > 0 ? count / ms[1] / 1e3 : 0.0,
+               ms[2] > 0 ? count / ms[2] / 1e3 : 0.0, ms[3] > 0 ? count / ms[3] / 1e3 : 0.0);
+        printf("       %zu hits, %zu misses, %zu slots (%.0f%% full), %zu left\n", hits, misses, capacity,
+               100.0 * count / capacity, dict->count);
+        free_dicts(interp);
+        free_string_arena(interp);
     }
+    free_dicts(interp);
+    free_string_arena(interp);
+    free(keys);
+    free(hashes);
+    free(interp);
+}
 
-    // Execute any remaining binary code
-    if (binary_start != -1) {
-        execute_binary(interp, binary_start, interp->position);
+// Print a plan bound, or why there is none
+void print_plan_bound(const char *label, long bound, const char *unbounded) {
+    printf(YELLOW "%-14s" RESET, label);
+    if (bound == PLAN_UNBOUNDED) {
+        printf("unbounded (%s)\n", unbounded);
+    } else {
+        printf("<= %ld\n", bound);
     }
+}
 
-    printf(BOLD GREEN "\nProgram execution completed successfully!\n" RESET);
-    printf(YELLOW "Variables created: %d\n" RESET, interp->var_count);
-    printf(CYAN "Stack operations: %d\n" RESET, interp->stack_pointer);
-    printf(MAGENTA "Final position: %d\n" RESET, interp->position);
+// --analyze: the resource plan of a loaded program, for capacity planning
+void print_resource_plan(NumoInterpreter *interp, const char *source_name) {
+    const ResourcePlan *plan = &interp->plan;
+    printf(BOLD "Resource plan for %s: %d digits\n" RESET, source_name, interp->code_length);
+    printf(YELLOW "%-14s" RESET, "Digits:");
+    for (int d = 0; d < 10; d++) {
+        printf("%d:%d%s", d, plan->digits[d], d < 9 ? "  " : "\n");
+    }
+    printf(YELLOW "%-14s" RESET "%d digits\n", "Loop bodies:", plan->loop_digits);
+    print_plan_bound("Variables:", plan->variables, "created in a loop or by a split");
+    printf(YELLOW "%-14s" RESET "%d of %d slots\n", "Store:", interp->var_capacity, MAX_VARIABLES);
+    print_plan_bound("IF frames:", plan->if_frames, "IF in a loop");
+    printf(YELLOW "%-14s" RESET "<= %d\n", "Loop frames:", plan->loop_frames);
+    printf(YELLOW "%-14s" RESET "%d\n", "Report files:", plan->report_files);
+    print_plan_bound("Output bytes:", plan->output_bytes, "loop, string input or extension");
 }
 
 // Print help
 void print_help() {
     printf(BOLD CYAN "Numo 0-9 Advanced Programming Language Interpreter\n" RESET);
     printf(YELLOW "=========================================\n" RESET);
-    printf("Usage: ./main <file.num> [options]\n\n");
+    printf("Usage: ./main <file.num> [options]\n");
+    printf("       ./main --workers N <a.num> <b.num> ...\n");
+    printf("       ./main --emit-c <file.num> > prog.c\n\n");
     printf(BOLD "Numo 0-9 Syntax:\n" RESET);
     printf(GREEN "0,1 - " RESET "Binary code (machine language)\n");
     printf(GREEN "2   - " RESET "End binary program\n");
@@ -810,33 +6327,274 @@ void print_help() {
 
     printf(BOLD "Options:\n" RESET);
     printf(YELLOW "-d, --debug   " RESET "Enable debug mode\n");
+    printf(YELLOW "-m, --memo    " RESET "Replay pure segments from the memo cache\n");
+    printf(YELLOW "--memo-file F " RESET "Load and save the memo cache in file F\n");
+    printf(YELLOW "--fold        " RESET "Evaluate the static prefix at load time\n");
+    printf(YELLOW "--emit-folded " RESET "Print the static prefix output and stop\n");
+    printf(YELLOW "--emit-c      " RESET "Print the program compiled to C and stop\n");
+    printf(YELLOW "--analyze     " RESET "Print the program's resource plan and stop\n");
+    printf(YELLOW "--compile-numc F " RESET "Write the program as a packed .numc container F and stop\n");
+    printf(YELLOW "--decode-to F " RESET "Decode the binary payloads to file F (- for stdout) and stop\n");
+    printf(YELLOW "--jit         " RESET "Run through the x86-64 JIT when available\n");
+    printf(YELLOW "--bench N     " RESET "Time N runs interpreted vs JIT\n");
+    printf(YELLOW "--slice N     " RESET "Run in resumable slices of N steps\n");
+    printf(YELLOW "--pipeline    " RESET "Read, run and write output on separate threads\n");
+    printf(YELLOW "--input F     " RESET "Read program input from file F (pause is skipped)\n");
+    printf(YELLOW "--headless    " RESET "No clear sequence, bell or pause wait\n");
+    printf(YELLOW "--headless-record " RESET "Like --headless, noting each skipped effect\n");
+    printf(YELLOW "--bignum      " RESET "Promote overflowing integer math to bignums\n");
+    printf(YELLOW "--bignum-bench " RESET "Time 10k-digit bignum power and multiplication\n");
+    printf(YELLOW "--arrays      " RESET "Digit 3 before a 7 creates a numeric array\n");
+    printf(YELLOW "--strings     " RESET "String ops: 82 concat, 92 split, 76/86 case, 96 search, 06 replace\n");
+    printf(YELLOW "--string-bench N " RESET "Search, case, replace and split on N MB of text\n");
+    printf(YELLOW "--array-bench N " RESET "Array kernels, reductions and sorts on N elements\n");
+    printf(YELLOW "--dicts       " RESET "Dictionaries: 39 new, 09 insert, 19 lookup, 29 delete\n");
+    printf(YELLOW "--dict-bench N " RESET "Dictionary inserts, lookups and deletes at N keys\n");
+    printf(YELLOW "--cache-dir D " RESET "Keep compiled programs in directory D, reuse them by content\n");
+    printf(YELLOW "--shm-cache   " RESET "Share compiled programs between processes through /dev/shm\n");
+    printf(YELLOW "--workers N   " RESET "Run all given programs on N scheduler threads\n");
+    printf(YELLOW "--sched-bench N " RESET "Programs/sec for N copies: scheduler vs processes\n");
+    printf(YELLOW "--max-instructions N " RESET "Stop after N instructions (exit 10)\n");
+    printf(YELLOW "--max-time S         " RESET "Stop after S seconds of wall time (exit 11)\n");
+    printf(YELLOW "--max-vars N         " RESET "Stop when more than N variables exist (exit 12)\n");
+    printf(YELLOW "--max-output N       " RESET "Stop after N bytes of output (exit 13)\n");
+    printf(YELLOW "--max-reports N      " RESET "Stop before report file N+1 (exit 14)\n");
     printf(YELLOW "-h, --help    " RESET "Show this help\n");
 }
 
+#ifndef NUMO_EMBEDDED
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        printf(RED "Error: No input file specified!\n" RESET);
-        print_help();
-        return 1;
-    }
-
     NumoInterpreter interp;
     init_interpreter(&interp);
+    const char *filename = NULL;
+    const char *memo_file = NULL;
+    bool fold = false;
+    bool emit_folded = false;
+    bool emit_c = false;
+    bool analyze = false;
+    bool pipeline = false;
+    const char *decode_to = NULL;
+    const char *numc_file = NULL;
+    int bench_runs = 0;
+    long slice = 0;
+    int workers = 0;
+    int sched_bench = 0;
+    const char **files = calloc(argc, sizeof(char *));
+    int file_count = 0;
 
-    // Parse command line arguments
-    for (int i = 2; i < argc; i++) {
+    // Parse command line arguments; the first non-option is the program
+    for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--debug") == 0) {
             interp.debug_mode = true;
+        } else if (strcmp(argv[i], "-m") == 0 || strcmp(argv[i], "--memo") == 0) {
+            interp.memo_enabled = true;
+        } else if (strcmp(argv[i], "--memo-file") == 0 && i + 1 < argc) {
+            interp.memo_enabled = true;
+            memo_file = argv[++i];
+        } else if (strcmp(argv[i], "--fold") == 0) {
+            fold = true;
+        } else if (strcmp(argv[i], "--emit-folded") == 0) {
+            emit_folded = true;
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            pipeline = true;
+        } else if (strcmp(argv[i], "--compile-numc") == 0 && i + 1 < argc) {
+            numc_file = argv[++i];
+        } else if (strcmp(argv[i], "--decode-to") == 0 && i + 1 < argc) {
+            decode_to = argv[++i];
+        } else if (strcmp(argv[i], "--emit-c") == 0) {
+            emit_c = true;
+        } else if (strcmp(argv[i], "--analyze") == 0) {
+            analyze = true;
+        } else if (strcmp(argv[i], "--jit") == 0) {
+            interp.jit_enabled = true;
+        } else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) {
+            bench_runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            FILE *input = fopen(argv[++i], "rb");
+            if (!input || !numo_load_input(&interp, input)) {
+                printf(RED "Error: Cannot read input file %s\n" RESET, argv[i]);
+                if (input) fclose(input);
+                return 1;
+            }
+            fclose(input);
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            interp.term_mode = TERM_HEADLESS;
+        } else if (strcmp(argv[i], "--headless-record") == 0) {
+            interp.term_mode = TERM_RECORD;
+        } else if (strcmp(argv[i], "--bignum") == 0) {
+            interp.bignum_enabled = true;
+        } else if (strcmp(argv[i], "--arrays") == 0) {
+            interp.arrays_enabled = true;
+        } else if (strcmp(argv[i], "--strings") == 0) {
+            interp.strings_enabled = true;
+        } else if (strcmp(argv[i], "--dicts") == 0) {
+            interp.dicts_enabled = true;
+        } else if (strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+            interp.cache_dir = argv[++i];
+        } else if (strcmp(argv[i], "--shm-cache") == 0) {
+            interp.shm_cache = true;
+        } else if (strcmp(argv[i], "--dict-bench") == 0 && i + 1 < argc) {
+            run_dict_benchmark(atol(argv[++i]));
+            return 0;
+        } else if (strcmp(argv[i], "--string-bench") == 0 && i + 1 < argc) {
+            run_string_benchmark(atol(argv[++i]));
+            return 0;
+        } else if (strcmp(argv[i], "--array-bench") == 0 && i + 1 < argc) {
+            run_array_benchmark(atol(argv[++i]));
+            return 0;
+        } else if (strcmp(argv[i], "--bignum-bench") == 0) {
+            run_bignum_benchmark();
+            return 0;
+        } else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--sched-bench") == 0 && i + 1 < argc) {
+            sched_bench = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--slice") == 0 && i + 1 < argc) {
+            slice = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--max-instructions") == 0 && i + 1 < argc) {
+            interp.limits.max_instructions = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--max-time") == 0 && i + 1 < argc) {
+            interp.limits.max_seconds = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-vars") == 0 && i + 1 < argc) {
+            interp.limits.max_variables = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-output") == 0 && i + 1 < argc) {
+            interp.limits.max_output_bytes = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--max-reports") == 0 && i + 1 < argc) {
+            interp.limits.max_report_files = atoi(argv[++i]);
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             print_help();
             return 0;
+        } else if (argv[i][0] != '-') {
+            if (!filename) filename = argv[i];
+            if (files) files[file_count++] = argv[i];
+        }
+    }
+
+    if (!filename) {
+        printf(RED "Error: No input file specified!\n" RESET);
+        print_help();
+        return 1;
+    }
+
+    if (decode_to) {
+        free(files);
+        return decode_program_file(filename, decode_to) ? 0 : 1;
+    }
+    if (numc_file) {
+        free(files);
+        interp.out = stderr;
+        return load_numo_file(&interp, filename) && write_numc(&interp, numc_file) ? 0 : 1;
+    }
+
+    // Generated C goes alone on stdout
+    if (emit_c) {
+        interp.out = stderr;
+        if (!load_numo_file(&interp, filename)) {
+            free(files);
+            return 1;
+        }
+        emit_c_program(&interp, filename, stdout);
+        free(interp.vars);
+        detach_shared_code(&interp);
+        free(files);
+        return 0;
+    }
+
+    // The resource plan goes alone on stdout
+    if (analyze) {
+        free(files);
+        interp.out = stderr;
+        if (!load_numo_file(&interp, filename)) {
+            return 1;
+        }
+        print_resource_plan(&interp, filename);
+        free(interp.vars);
+        detach_shared_code(&interp);
+        return 0;
+    }
+
+    // Direct output of the folded prefix goes alone on stdout
+    if (emit_folded) {
+        interp.out = stderr;
+        if (!load_numo_file(&interp, filename) || !fold_static_prefix(&interp)) {
+            return 1;
+        }
+        fwrite(interp.fold_output, 1, interp.fold_output_len, stdout);
+        if (interp.fold_position < interp.code_length) {
+            fprintf(stderr, YELLOW "Residual program starts at position %d (digit '%c')\n" RESET,
+                    interp.fold_position, interp.code[interp.fold_position]);
+        }
+        free(interp.fold_output);
+        return 0;
+    }
+
+    ResourceLimits *limits = &interp.limits;
+    interp.limits_active = limits->max_instructions > 0 || limits->max_seconds > 0 ||
+                           limits->max_variables > 0 || limits->max_output_bytes > 0 ||
+                           limits->max_report_files > 0;
+
+    // Several programs (or --workers) go through the scheduler
+    if (sched_bench > 0) {
+        run_scheduler_benchmark(filename, sched_bench, &interp);
+        free(files);
+        return 0;
+    }
+    if (file_count > 1 || workers > 0) {
+        int exit_code = run_batch(files, file_count, &interp, workers > 0 ? workers : 4, slice > 0 ? slice : 1000);
+        free(files);
+        return exit_code;
+    }
+    free(files);
+
+    if (bench_runs > 0) {
+        if (load_numo_file(&interp, filename)) {
+            run_benchmark(&interp, bench_runs);
         }
+        free_jit(&interp);
+        return 0;
+    }
+
+    WriterStage writer;
+    bool piped = pipeline && open_output_pipeline(&interp, &writer);
+    if (limits->max_output_bytes > 0 && !open_output_limit(&interp)) {
+        if (piped) close_output_pipeline(&interp, &writer);
+        printf(RED "Error: Cannot limit output\n" RESET);
+        return 1;
+    }
+    if (limits->max_seconds > 0) {
+        arm_wall_time_watchdog(limits->max_seconds);
     }
 
     // Load and execute the Numo file
-    if (load_numo_file(&interp, argv[1])) {
-        interpret(&interp);
+    if (pipeline ? load_numo_pipelined(&interp, filename) : load_numo_file(&interp, filename)) {
+        if (fold) {
+            fold_static_prefix(&interp);
+        }
+        if (memo_file) {
+            load_memo_file(&interp, memo_file);
+        }
+        if (slice > 0) {
+            run_sliced(&interp, slice);
+        } else {
+            interpret(&interp);
+        }
+        if (memo_file) {
+            save_memo_file(&interp, memo_file);
+        }
     }
+    free_memo_table(&interp);
+    free(interp.fold_output);
+    free_jit(&interp);
+    close_output_limit(&interp);
+    if (piped) close_output_pipeline(&interp, &writer);
+    free(interp.input_data);
+    free_bignums(&interp);
+    free_arrays(&interp);
+    free_string_arena(&interp);
+    free_dicts(&interp);
+    detach_shared_code(&interp);
+    free(interp.vars);
 
-    return 0;
-}
\ No newline at end of file
+    return limit_exit_code(interp.limit_hit);
+}
+#endif
\ No newline at end of file